@@ -54,6 +54,10 @@
 /* USER CODE BEGIN 0 */
   extern void configureTimerForRunTimeStats(void);
   extern unsigned long getRunTimeCounterValue(void);
+  #include <stddef.h>
+  extern void heap_monitor_on_malloc(void *addr, size_t size, void *caller);
+  extern void heap_monitor_on_free(void *addr, size_t size, void *caller);
+  #include "trace_recorder.h"
 /* USER CODE END 0 */
 #endif
 #define configENABLE_FPU                         0
@@ -69,6 +73,7 @@
 #define configMAX_PRIORITIES                     ( 7 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
 #define configTOTAL_HEAP_SIZE                    ((size_t)15360)
+#define configAPPLICATION_ALLOCATED_HEAP         1
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configGENERATE_RUN_TIME_STATS            1
 #define configUSE_TRACE_FACILITY                 1
@@ -77,6 +82,7 @@
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
+#define configCHECK_FOR_STACK_OVERFLOW           2
 #define configRECORD_STACK_HIGH_ADDRESS          1
 /* USER CODE BEGIN MESSAGE_BUFFER_LENGTH_TYPE */
 /* Defaults to size_t for backward compatibility, but can be changed
@@ -98,6 +104,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil              1
 #define INCLUDE_vTaskDelay                   1
 #define INCLUDE_xTaskGetSchedulerState       1
+#define INCLUDE_uxTaskGetStackHighWaterMark  1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -148,6 +155,35 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* RTOS heap implementation: heap_4 first fit in ucHeap, heap_5 first fit over
+   the CCM and SRAM regions left by the linker, or TLSF with constant time
+   pvPortMalloc/vPortFree. configTOTAL_HEAP_SIZE is unused by heap_5. */
+#define configHEAP_SCHEME_HEAP_4                 4
+#define configHEAP_SCHEME_HEAP_5                 5
+#define configHEAP_SCHEME_TLSF                   6
+#define configHEAP_SCHEME                        configHEAP_SCHEME_HEAP_5
+/* Heap allocation tracing. The return address is taken inside pvPortMalloc and
+   vPortFree, so it points into their caller. heap_5 allocates in a helper, it
+   takes the address in pvPortMalloc and passes it to traceMALLOC_FROM. */
+#define traceMALLOC( pvAddress, uiSize ) heap_monitor_on_malloc( ( pvAddress ), ( uiSize ), __builtin_return_address( 0 ) )
+#define traceMALLOC_FROM( pvAddress, uiSize, pvCaller ) heap_monitor_on_malloc( ( pvAddress ), ( uiSize ), ( pvCaller ) )
+#define traceFREE( pvAddress, uiSize ) heap_monitor_on_free( ( pvAddress ), ( uiSize ), __builtin_return_address( 0 ) )
+/* Kernel trace recorder (trace_recorder.h). Task and queue trace ids are kept
+   in the numbers FreeRTOS reserves for trace tools. Queue depths are taken
+   before the operation. */
+#define configUSE_TRACE_RECORDER                 0
+#if ( configUSE_TRACE_RECORDER == 1 )
+#define traceTASK_CREATE( pxNewTCB ) ( pxNewTCB )->uxTaskNumber = trace_recorder_on_task_create( ( pxNewTCB )->pcTaskName )
+#define traceTASK_SWITCHED_IN() trace_recorder_put( TRACE_REC_TASK_IN, ( uint8_t ) pxCurrentTCB->uxTaskNumber, 0 )
+#define traceTASK_SWITCHED_OUT() trace_recorder_put( TRACE_REC_TASK_OUT, ( uint8_t ) pxCurrentTCB->uxTaskNumber, 0 )
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB ) trace_recorder_put( TRACE_REC_TASK_READY, ( uint8_t ) ( pxTCB )->uxTaskNumber, 0 )
+#define traceTASK_INCREMENT_TICK( xTickCount ) trace_recorder_put( TRACE_REC_TICK, 0, ( uint16_t ) ( xTickCount ) )
+#define traceQUEUE_CREATE( pxNewQueue ) ( pxNewQueue )->uxQueueNumber = trace_recorder_on_queue_create()
+#define traceQUEUE_SEND( pxQueue ) trace_recorder_put( TRACE_REC_QUEUE_SEND, ( uint8_t ) ( pxQueue )->uxQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) traceQUEUE_SEND( pxQueue )
+#define traceQUEUE_RECEIVE( pxQueue ) trace_recorder_put( TRACE_REC_QUEUE_RECEIVE, ( uint8_t ) ( pxQueue )->uxQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) traceQUEUE_RECEIVE( pxQueue )
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -24,7 +24,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include "linker_sections.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -44,7 +44,16 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+/* RTOS heap (configAPPLICATION_ALLOCATED_HEAP). Kernel objects and AO stacks
+   are allocated from it, so it must not hold DMA buffers. heap_5 takes its
+   regions from the linker instead, see heap_regions.c. */
+#if (configHEAP_SCHEME != configHEAP_SCHEME_HEAP_5)
+#if 1 == LINKER_CONFIG_HEAP_IN_CCM
+uint8_t ucHeap[configTOTAL_HEAP_SIZE] LINKER_SECTION_CCM;
+#else
+uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#endif
+#endif
 /* USER CODE END Variables */
 
 /* Private function prototypes -----------------------------------------------*/
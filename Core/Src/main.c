@@ -30,6 +30,8 @@
 
 /* Application includes. */
 #include "app.h"
+#include "cpu_load.h"
+#include "stack_monitor.h"
 
 /* USER CODE END Includes */
 
@@ -462,6 +464,8 @@ void vApplicationIdleHook(void)
 	   is paramount that the idle hook function does not call any API functions
 	   that could cause it to block.*/
 //	LOGGER_LOG("  +\r\n");
+	cpu_load_idle();
+	stack_monitor_idle();
 }
 
 void vApplicationTickHook(void)
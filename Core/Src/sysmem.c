@@ -55,8 +55,15 @@ void *_sbrk(ptrdiff_t incr)
   extern uint8_t _end; /* Symbol defined in the linker script */
   extern uint8_t _estack; /* Symbol defined in the linker script */
   extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
+  extern uint8_t _sheap_sram; /* Start of the RTOS heap_5 SRAM region */
   const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
   const uint8_t *max_heap = (uint8_t *)stack_limit;
+
+  /* The SRAM above _sheap_sram belongs to the RTOS heap */
+  if (max_heap > &_sheap_sram)
+  {
+    max_heap = &_sheap_sram;
+  }
   uint8_t *prev_heap_end;
 
   /* Initialize heap end at first call */
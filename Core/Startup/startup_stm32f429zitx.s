@@ -93,6 +93,19 @@ FillZerobss:
 LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
+
+/* Zero fill the CCM-RAM bss segment. */
+  ldr r2, =_sccmbss
+  ldr r4, =_eccmbss
+  b LoopFillZeroccmbss
+
+FillZeroccmbss:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopFillZeroccmbss:
+  cmp r2, r4
+  bcc FillZeroccmbss
   
 /* Call static constructors */
     bl __libc_init_array
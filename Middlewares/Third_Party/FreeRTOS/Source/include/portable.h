@@ -151,6 +151,12 @@ typedef struct xHeapStats
  */
 void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
 
+/*
+ * heap_5.c only.  Allocates from the xRegion'th entry of the array passed to
+ * vPortDefineHeapRegions(), returns NULL if it does not fit there.
+ */
+void *pvPortMallocFromRegion( size_t xWantedSize, BaseType_t xRegion ) PRIVILEGED_FUNCTION;
+
 /*
  * Returns a HeapStats_t structure filled with information about the current
  * heap state.
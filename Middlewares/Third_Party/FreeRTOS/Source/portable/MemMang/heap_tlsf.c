@@ -0,0 +1,617 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() based on the two level
+ * segregated fit (TLSF) allocator.  Free blocks are kept in segregated lists
+ * indexed by two bitmaps, so both pvPortMalloc() and vPortFree() run in
+ * constant time, whatever the fragmentation of the heap.  Adjacent free blocks
+ * are coalesced as they are freed, as heap_4.c does.
+ *
+ * Selected with configHEAP_SCHEME set to configHEAP_SCHEME_TLSF.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configHEAP_SCHEME == configHEAP_SCHEME_TLSF )
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#if( portBYTE_ALIGNMENT != 8 )
+	#error This file assumes 8 byte alignment
+#endif
+
+/* Log2 of the number of second level lists per first level class. */
+#define tlsfSL_INDEX_COUNT_LOG2		( 4 )
+#define tlsfSL_INDEX_COUNT			( 1U << tlsfSL_INDEX_COUNT_LOG2 )
+
+/* Log2 of the block alignment. */
+#define tlsfALIGN_SIZE_LOG2			( 3 )
+#define tlsfALIGN_SIZE				( 1U << tlsfALIGN_SIZE_LOG2 )
+
+/* Blocks below tlsfSMALL_BLOCK_SIZE share the first class, split linearly. */
+#define tlsfFL_INDEX_SHIFT			( tlsfSL_INDEX_COUNT_LOG2 + tlsfALIGN_SIZE_LOG2 )
+#define tlsfSMALL_BLOCK_SIZE		( ( size_t ) 1 << tlsfFL_INDEX_SHIFT )
+
+/* Largest block is below 1 << tlsfFL_INDEX_MAX, 128KB covers any heap that
+fits the internal RAM. */
+#define tlsfFL_INDEX_MAX			( 17 )
+#define tlsfFL_INDEX_COUNT			( tlsfFL_INDEX_MAX - tlsfFL_INDEX_SHIFT + 1 )
+
+/* Flags kept in the low bits of xBlockSize, sizes are multiple of 8. */
+#define tlsfBLOCK_FREE				( ( size_t ) 1 )
+#define tlsfBLOCK_PREV_FREE			( ( size_t ) 2 )
+#define tlsfBLOCK_SIZE_MASK			( ~( ( size_t ) tlsfALIGN_SIZE - 1 ) )
+
+/* Block sizes must not get too small, a free block holds the list links. */
+#define tlsfMIN_BLOCK_SIZE			( sizeof( BlockLink_t * ) * 2 )
+#define tlsfMAX_BLOCK_SIZE			( ( ( size_t ) 1 << tlsfFL_INDEX_MAX ) - 1 )
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* Header placed in front of every block.  pxPrevFreeBlock and pxNextFreeBlock
+are only valid while the block is free, they live in the block payload. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxPrevPhysBlock;	/*<< The block just before this one in memory. */
+	size_t xBlockSize;						/*<< Payload size, flags in the low bits. */
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next block in the same free list. */
+	struct A_BLOCK_LINK *pxPrevFreeBlock;	/*<< The previous block in the same free list. */
+} BlockLink_t;
+
+/* Space taken by an allocated block on top of its payload. */
+#define tlsfBLOCK_OVERHEAD			( sizeof( BlockLink_t * ) + sizeof( size_t ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Compute the free list of a block size, rounding down (insert) or rounding
+ * up to the next list so any block found there fits (search).
+ */
+static void prvMappingInsert( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl );
+static void prvMappingSearch( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl );
+
+/*
+ * Free list handling.
+ */
+static BlockLink_t *prvSearchSuitableBlock( UBaseType_t *puxFl, UBaseType_t *puxSl );
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock, UBaseType_t uxFl, UBaseType_t uxSl );
+static void prvInsertFreeBlock( BlockLink_t *pxBlock );
+static void prvRemoveBlock( BlockLink_t *pxBlock );
+
+/*
+ * Physical block handling.
+ */
+static BlockLink_t *prvNextPhysBlock( const BlockLink_t *pxBlock );
+static void prvSetFree( BlockLink_t *pxBlock, BaseType_t xFree );
+static BlockLink_t *prvMergePrev( BlockLink_t *pxBlock );
+static void prvMergeNext( BlockLink_t *pxBlock );
+static void prvTrimFree( BlockLink_t *pxBlock, size_t xSize );
+
+/*-----------------------------------------------------------*/
+
+/* Bitmaps of the non empty lists and the list heads. */
+static uint32_t ulFlBitmap = 0U;
+static uint32_t ulSlBitmap[ tlsfFL_INDEX_COUNT ];
+static BlockLink_t *pxBlocks[ tlsfFL_INDEX_COUNT ][ tlsfSL_INDEX_COUNT ];
+
+static BaseType_t xHeapInitialised = pdFALSE;
+
+/* Keeps track of the number of calls to allocate and free memory as well as the
+number of free bytes remaining, but says nothing about fragmentation.  Like
+heap_4.c, free bytes include the block headers. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+static size_t prvBlockSize( const BlockLink_t *pxBlock )
+{
+	return pxBlock->xBlockSize & tlsfBLOCK_SIZE_MASK;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFls( size_t xValue )
+{
+	/* Index of the most significant bit set, xValue is never 0. */
+	return ( UBaseType_t ) ( 31 - __builtin_clz( ( unsigned int ) xValue ) );
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFfs( uint32_t ulValue )
+{
+	/* Index of the least significant bit set, ulValue is never 0. */
+	return ( UBaseType_t ) __builtin_ctz( ulValue );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockLink_t *pxBlock;
+UBaseType_t uxFl, uxSl;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the free lists. */
+		if( xHeapInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= tlsfMAX_BLOCK_SIZE ) )
+		{
+			/* Round the payload up to the alignment and to the smallest block
+			able to hold the free list links once freed. */
+			xWantedSize = ( xWantedSize + ( tlsfALIGN_SIZE - 1 ) ) & tlsfBLOCK_SIZE_MASK;
+			if( xWantedSize < tlsfMIN_BLOCK_SIZE )
+			{
+				xWantedSize = tlsfMIN_BLOCK_SIZE;
+			}
+
+			prvMappingSearch( xWantedSize, &uxFl, &uxSl );
+
+			if( uxFl < tlsfFL_INDEX_COUNT )
+			{
+				pxBlock = prvSearchSuitableBlock( &uxFl, &uxSl );
+
+				if( pxBlock != NULL )
+				{
+					prvRemoveFreeBlock( pxBlock, uxFl, uxSl );
+					prvTrimFree( pxBlock, xWantedSize );
+					prvSetFree( pxBlock, pdFALSE );
+
+					xFreeBytesRemaining -= prvBlockSize( pxBlock ) + tlsfBLOCK_OVERHEAD;
+
+					if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+					{
+						xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + tlsfBLOCK_OVERHEAD );
+					xNumberOfSuccessfulAllocations++;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceMALLOC( pvReturn, xWantedSize + tlsfBLOCK_OVERHEAD );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+BlockLink_t *pxBlock;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a header immediately before it. */
+		pxBlock = ( BlockLink_t * ) ( ( ( uint8_t * ) pv ) - tlsfBLOCK_OVERHEAD );
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxBlock->xBlockSize & tlsfBLOCK_FREE ) == 0 );
+
+		if( ( pxBlock->xBlockSize & tlsfBLOCK_FREE ) == 0 )
+		{
+			vTaskSuspendAll();
+			{
+				xFreeBytesRemaining += prvBlockSize( pxBlock ) + tlsfBLOCK_OVERHEAD;
+				traceFREE( pv, prvBlockSize( pxBlock ) + tlsfBLOCK_OVERHEAD );
+
+				prvSetFree( pxBlock, pdTRUE );
+				pxBlock = prvMergePrev( pxBlock );
+				prvMergeNext( pxBlock );
+				prvInsertFreeBlock( pxBlock );
+				xNumberOfSuccessfulFrees++;
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+BlockLink_t *pxFirstBlock, *pxSentinel;
+size_t uxAddress, uxEnd;
+
+	/* Ensure the heap starts and ends on correctly aligned boundaries. */
+	uxAddress = ( size_t ) ucHeap;
+	uxEnd = uxAddress + configTOTAL_HEAP_SIZE;
+	uxAddress = ( uxAddress + ( tlsfALIGN_SIZE - 1 ) ) & tlsfBLOCK_SIZE_MASK;
+	uxEnd &= tlsfBLOCK_SIZE_MASK;
+
+	/* One free block spans the whole heap.  A zero sized used block at the
+	end stops merges from walking out of it. */
+	pxFirstBlock = ( BlockLink_t * ) uxAddress;
+	pxFirstBlock->pxPrevPhysBlock = NULL;
+	pxFirstBlock->xBlockSize = ( uxEnd - uxAddress - ( 2 * tlsfBLOCK_OVERHEAD ) ) & tlsfBLOCK_SIZE_MASK;
+
+	if( pxFirstBlock->xBlockSize > tlsfMAX_BLOCK_SIZE )
+	{
+		/* Larger than the largest class, the rest of the heap is not used. */
+		pxFirstBlock->xBlockSize = tlsfMAX_BLOCK_SIZE & tlsfBLOCK_SIZE_MASK;
+	}
+
+	pxSentinel = prvNextPhysBlock( pxFirstBlock );
+	pxSentinel->pxPrevPhysBlock = pxFirstBlock;
+	pxSentinel->xBlockSize = 0;
+
+	prvSetFree( pxFirstBlock, pdTRUE );
+	prvInsertFreeBlock( pxFirstBlock );
+
+	xFreeBytesRemaining = prvBlockSize( pxFirstBlock ) + tlsfBLOCK_OVERHEAD;
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+
+	xHeapInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+UBaseType_t uxFl, uxSl;
+
+	if( xSize < tlsfSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are split linearly in the first class. */
+		uxFl = 0;
+		uxSl = ( UBaseType_t ) ( xSize / ( tlsfSMALL_BLOCK_SIZE / tlsfSL_INDEX_COUNT ) );
+	}
+	else
+	{
+		uxFl = prvFls( xSize );
+		uxSl = ( UBaseType_t ) ( xSize >> ( uxFl - tlsfSL_INDEX_COUNT_LOG2 ) ) ^ tlsfSL_INDEX_COUNT;
+		uxFl -= ( tlsfFL_INDEX_SHIFT - 1 );
+	}
+
+	*puxFl = uxFl;
+	*puxSl = uxSl;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+	if( xSize >= tlsfSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( prvFls( xSize ) - tlsfSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xSize, puxFl, puxSl );
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvSearchSuitableBlock( UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+UBaseType_t uxFl = *puxFl, uxSl;
+uint32_t ulSlMap, ulFlMap;
+
+	/* First look for a large enough list in the same class. */
+	ulSlMap = ulSlBitmap[ uxFl ] & ( ~0UL << *puxSl );
+
+	if( ulSlMap == 0 )
+	{
+		/* None, take the smallest list of the next non empty class. */
+		ulFlMap = ( uxFl + 1 < 32 ) ? ( ulFlBitmap & ( ~0UL << ( uxFl + 1 ) ) ) : 0;
+
+		if( ulFlMap == 0 )
+		{
+			return NULL;
+		}
+
+		uxFl = prvFfs( ulFlMap );
+		ulSlMap = ulSlBitmap[ uxFl ];
+	}
+
+	uxSl = prvFfs( ulSlMap );
+
+	*puxFl = uxFl;
+	*puxSl = uxSl;
+	return pxBlocks[ uxFl ][ uxSl ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock, UBaseType_t uxFl, UBaseType_t uxSl )
+{
+BlockLink_t *pxPrev = pxBlock->pxPrevFreeBlock;
+BlockLink_t *pxNext = pxBlock->pxNextFreeBlock;
+
+	if( pxNext != NULL )
+	{
+		pxNext->pxPrevFreeBlock = pxPrev;
+	}
+
+	if( pxPrev != NULL )
+	{
+		pxPrev->pxNextFreeBlock = pxNext;
+	}
+	else
+	{
+		/* Head of its list. */
+		pxBlocks[ uxFl ][ uxSl ] = pxNext;
+
+		if( pxNext == NULL )
+		{
+			ulSlBitmap[ uxFl ] &= ~( 1UL << uxSl );
+
+			if( ulSlBitmap[ uxFl ] == 0 )
+			{
+				ulFlBitmap &= ~( 1UL << uxFl );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockLink_t *pxBlock )
+{
+UBaseType_t uxFl, uxSl;
+BlockLink_t *pxCurrent;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+	pxCurrent = pxBlocks[ uxFl ][ uxSl ];
+
+	pxBlock->pxNextFreeBlock = pxCurrent;
+	pxBlock->pxPrevFreeBlock = NULL;
+
+	if( pxCurrent != NULL )
+	{
+		pxCurrent->pxPrevFreeBlock = pxBlock;
+	}
+
+	pxBlocks[ uxFl ][ uxSl ] = pxBlock;
+	ulFlBitmap |= ( 1UL << uxFl );
+	ulSlBitmap[ uxFl ] |= ( 1UL << uxSl );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveBlock( BlockLink_t *pxBlock )
+{
+UBaseType_t uxFl, uxSl;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+	prvRemoveFreeBlock( pxBlock, uxFl, uxSl );
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvNextPhysBlock( const BlockLink_t *pxBlock )
+{
+	return ( BlockLink_t * ) ( ( ( uint8_t * ) pxBlock ) + tlsfBLOCK_OVERHEAD + prvBlockSize( pxBlock ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetFree( BlockLink_t *pxBlock, BaseType_t xFree )
+{
+BlockLink_t *pxNext = prvNextPhysBlock( pxBlock );
+
+	/* The next block keeps track of this one, so merges find it. */
+	if( xFree != pdFALSE )
+	{
+		pxBlock->xBlockSize |= tlsfBLOCK_FREE;
+		pxNext->xBlockSize |= tlsfBLOCK_PREV_FREE;
+	}
+	else
+	{
+		pxBlock->xBlockSize &= ~tlsfBLOCK_FREE;
+		pxNext->xBlockSize &= ~tlsfBLOCK_PREV_FREE;
+	}
+
+	pxNext->pxPrevPhysBlock = pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvMergePrev( BlockLink_t *pxBlock )
+{
+BlockLink_t *pxPrev;
+
+	if( ( pxBlock->xBlockSize & tlsfBLOCK_PREV_FREE ) != 0 )
+	{
+		pxPrev = pxBlock->pxPrevPhysBlock;
+		prvRemoveBlock( pxPrev );
+
+		/* The previous block absorbs this one, header included. */
+		pxPrev->xBlockSize += prvBlockSize( pxBlock ) + tlsfBLOCK_OVERHEAD;
+		prvNextPhysBlock( pxPrev )->pxPrevPhysBlock = pxPrev;
+		pxBlock = pxPrev;
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMergeNext( BlockLink_t *pxBlock )
+{
+BlockLink_t *pxNext = prvNextPhysBlock( pxBlock );
+
+	if( ( pxNext->xBlockSize & tlsfBLOCK_FREE ) != 0 )
+	{
+		prvRemoveBlock( pxNext );
+		pxBlock->xBlockSize += prvBlockSize( pxNext ) + tlsfBLOCK_OVERHEAD;
+		prvNextPhysBlock( pxBlock )->pxPrevPhysBlock = pxBlock;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrimFree( BlockLink_t *pxBlock, size_t xSize )
+{
+BlockLink_t *pxRemaining;
+size_t xRemainingSize;
+
+	/* Split only when the rest can hold a block of its own. */
+	if( prvBlockSize( pxBlock ) >= ( xSize + tlsfBLOCK_OVERHEAD + tlsfMIN_BLOCK_SIZE ) )
+	{
+		xRemainingSize = prvBlockSize( pxBlock ) - xSize - tlsfBLOCK_OVERHEAD;
+		pxBlock->xBlockSize = xSize | ( pxBlock->xBlockSize & ~tlsfBLOCK_SIZE_MASK );
+
+		pxRemaining = prvNextPhysBlock( pxBlock );
+		pxRemaining->pxPrevPhysBlock = pxBlock;
+		/* The block in front is free while being trimmed. */
+		pxRemaining->xBlockSize = xRemainingSize | tlsfBLOCK_PREV_FREE;
+		prvSetFree( pxRemaining, pdTRUE );
+		prvInsertFreeBlock( pxRemaining );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockLink_t *pxBlock;
+UBaseType_t uxFl, uxSl;
+size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+
+	vTaskSuspendAll();
+	{
+		/* Only for diagnostics, the walk is not bounded in time. */
+		for( uxFl = 0; uxFl < tlsfFL_INDEX_COUNT; uxFl++ )
+		{
+			for( uxSl = 0; uxSl < tlsfSL_INDEX_COUNT; uxSl++ )
+			{
+				for( pxBlock = pxBlocks[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+				{
+					size_t xSize = prvBlockSize( pxBlock ) + tlsfBLOCK_OVERHEAD;
+					xBlocks++;
+
+					if( xSize > xMaxSize )
+					{
+						xMaxSize = xSize;
+					}
+
+					if( xSize < xMinSize )
+					{
+						xMinSize = xSize;
+					}
+				}
+			}
+		}
+	}
+	xTaskResumeAll();
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+	pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+	taskENTER_CRITICAL();
+	{
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+	}
+	taskEXIT_CRITICAL();
+}
+
+#endif /* configHEAP_SCHEME */
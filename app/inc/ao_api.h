@@ -20,6 +20,7 @@ typedef struct {
   ao_t sender;                     /*< AO send of this message */
   ao_t receiver;                   /*< AO receiving this message */
   uint8_t ao_msg_size;             /*< AO message size */
+  uint8_t ao_msg_flags;            /*< AO message flags (AO_MSG_F_*) */
   uint8_t ao_msg[AO_MAX_MSG_SIZE]; /*< AO message pointer*/
 } ao_msg_t;
 
@@ -35,8 +36,74 @@ typedef enum {
   AO_E_SIZE,
   AO_E_ARG,
   AO_E_OS,
+  AO_E_FULL,
+  AO_E_THROTTLED,
 } ao_err_t;
 
+/**
+ * @brief What a send does when the inbox is full.
+ *
+ */
+typedef enum {
+  AO_POLICY_DEFAULT = 0, /*< Per send only, use the policy of the inbox AO */
+  AO_POLICY_DROP_NEWEST, /*< Discard the message sent */
+  AO_POLICY_DROP_OLDEST, /*< Discard the oldest queued message */
+  AO_POLICY_OVERWRITE,   /*< Replace the newest queued message */
+  AO_POLICY_BLOCK,       /*< Wait for room, then discard the message sent */
+} ao_policy_t;
+
+/**
+ * @brief AO inbox overflow counters.
+ *
+ */
+typedef struct {
+  uint32_t overflows; /*< Sends that found the inbox full */
+  uint32_t dropped;   /*< Messages discarded, sent or queued */
+  uint32_t blocked;   /*< Sends that waited for room */
+} ao_overflow_stats_t;
+
+/**
+ * @brief AO receiver throttling counters.
+ *
+ */
+typedef struct {
+  uint32_t rate_limited; /*< Sends refused by a token bucket */
+  uint32_t not_admitted; /*< Sends refused by admission control */
+} ao_throttle_stats_t;
+
+/**
+ * @brief AO deadline counters. Times are in DWT cycles.
+ *
+ */
+typedef struct {
+  uint32_t late;     /*< Messages handled after their wait budget */
+  uint32_t overruns; /*< Handlers run longer than their run budget */
+  uint32_t wait_max; /*< Worst time from post to handler */
+  uint32_t run_max;  /*< Worst handler run time */
+} ao_deadline_stats_t;
+
+/**
+ * @brief Message that missed a deadline of its receiver.
+ *
+ */
+typedef struct {
+  ao_msg_t ao_msg; /*< Message as given to the handler */
+  uint32_t wait;   /*< Cycles from post to handler */
+  uint32_t run;    /*< Cycles in the handler */
+  uint32_t tick;   /*< Tick when the handler returned */
+} ao_deadline_miss_t;
+
+/**
+ * @brief AO resources, fields left at 0 (or NULL) take the defaults.
+ *
+ */
+typedef struct {
+  const char *name;    /*< Task name, "ao_task_<n>" by default */
+  uint16_t stack_size; /*< Task stack depth in words, AO_TASK_STACK_SIZE */
+  uint8_t priority;    /*< Task priority, tskIDLE_PRIORITY + AO_TASK_PRIORITY */
+  uint8_t queue_len;   /*< Inbox queue length, AO_MAX_QUEUE_MSG */
+} ao_config_t;
+
 /**
  * @brief AO event handler.
  */
@@ -44,9 +111,25 @@ typedef void (*ao_ev_handler_t)(ao_msg_t *ao_msg);
 
 /**
  * @brief Free handler used commonly by a message's AO sender.
+ *
+ * @note Kept only for compatibility. Every message reaches its handler
+ * flagged AO_MSG_F_NO_FREE, so no free handler is ever called.
  */
 typedef void (*ao_free_handler_t)(ao_msg_t *ao_msg);
 
+/**
+ * @brief Overflow handler, called in the sender context with the message
+ * discarded by the policy of the inbox AO.
+ */
+typedef void (*ao_overflow_handler_t)(ao_t ao, ao_msg_t *ao_msg);
+
+/**
+ * @brief Deadline handler, called in the task that ran the handler when a
+ * message misses a deadline of its receiver.
+ */
+typedef void (*ao_deadline_handler_t)(ao_t ao,
+                                      const ao_deadline_miss_t *ao_miss);
+
 /**
  * @brief Initialize AO object.
  *
@@ -54,15 +137,34 @@ typedef void (*ao_free_handler_t)(ao_msg_t *ao_msg);
  * makes that the AO doesnt create these OS resources. An AO with this options
  * enable must need a sender in 'ao_send_message' method to receive events.
  *
+ * @note An AO with (AO_OP_COALESCE) keeps a single message slot. Messages sent
+ * while a previous one is still pending overwrite it, so only the latest value
+ * is handled and its inbox can never overflow. Use it for state-like events.
+ *
+ * @note An AO with (AO_OP_LOCKFREE) replaces its queue by a lock-free ring of
+ * AO_INBOX_SIZE messages. Posting takes no critical section and its task
+ * sleeps on a direct to task notification, given only when it waits. It
+ * needs its own task.
+ *
+ * @note An AO with (AO_OP_SYNC) accepts 'ao_call', which runs its handler in
+ * the caller task. It must be a passive AO (AO_OP_NO_TASK).
+ *
+ * @note 'ao_cfg' sizes the task and the queue of the AO, e.g. a deeper queue
+ * for bursty AOs or a smaller stack for simple ones. Its name shows in the
+ * run time stats and the stack monitor. A lock-free inbox has a fixed size,
+ * its 'queue_len' is ignored. Passive AOs take none of it, pass NULL.
+ *
  * @param ao_data AO aditional data.
  * @param ao_data_size AO aditional data size.
  * @param ao_ev_f AO event handler.
- * @param ao_free_f AO free message handler (if sender)
+ * @param ao_free_f Not used, kept for compatibility, pass NULL.
  * @param ao_op AO flag operations.
+ * @param ao_cfg AO resources, NULL for the defaults.
  * @return ao_t Allocated AO object.
  */
 ao_t ao_init(uint8_t *ao_data, uint8_t ao_data_size, ao_ev_handler_t ao_ev_f,
-             ao_free_handler_t ao_free_f, ao_op_t ao_op);
+             ao_free_handler_t ao_free_f, ao_op_t ao_op,
+             const ao_config_t *ao_cfg);
 /**
  * @brief Deinit an AO object.
  *
@@ -97,6 +199,11 @@ uint8_t ao_get_data_size(ao_t ao);
  * queue and task, it will always returns error as the AO is no suited for this
  * method; in this case a sender with queue and task implemented is a MUST.
  *
+ * @note Nothing is allocated. Messages up to AO_EV_PAYLOAD_SIZE bytes travel
+ * by value inside the inbox, larger ones hold a block of a static pool until
+ * handled (AO_E_NO_MEM if every block is taken). The handler gets them flagged
+ * AO_MSG_F_NO_FREE, so free methods do nothing with them.
+ *
  * @param receiver Receiver AO.
  * @param sender Sender AO.
  * @param ao_msg AO message pointer.
@@ -106,9 +213,205 @@ uint8_t ao_get_data_size(ao_t ao);
  */
 int ao_send_message(ao_t receiver, ao_t sender, uint8_t *ao_msg,
                     uint8_t ao_msg_size);
+/**
+ * @brief Send a message for an AO with an overflow policy.
+ *
+ * @note Same as 'ao_send_message', which uses AO_POLICY_DEFAULT. The policy
+ * applies when the inbox handling the message is full, whatever it is, the
+ * discarded message is reclaimed and counted.
+ *
+ * A lock-free inbox (AO_OP_LOCKFREE) can only be consumed by its task, so it
+ * drops the newest message for AO_POLICY_DROP_OLDEST and AO_POLICY_OVERWRITE,
+ * and AO_POLICY_BLOCK retries once per tick.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO.
+ * @param ao_msg AO message pointer.
+ * @param ao_msg_size AO message size.
+ * @param policy Overflow policy.
+ * @param timeout_ms Wait for AO_POLICY_BLOCK, in milliseconds.
+ * @return int
+ * 				- AO_OK if no error.
+ * 				- AO_E_FULL if the message was discarded.
+ */
+int ao_send_message_ex(ao_t receiver, ao_t sender, uint8_t *ao_msg,
+                       uint8_t ao_msg_size, ao_policy_t policy,
+                       uint32_t timeout_ms);
+/**
+ * @brief Set the overflow policy of the inbox of an AO.
+ *
+ * @note It applies to every message posted in this AO inbox, including the
+ * ones for passive AOs handled by it. AOs start with AO_POLICY_DROP_NEWEST.
+ *
+ * @param ao AO instance with an inbox.
+ * @param policy Overflow policy, AO_POLICY_DEFAULT is not allowed.
+ * @param timeout_ms Wait for AO_POLICY_BLOCK, in milliseconds.
+ * @param ao_overflow_f Called for every discarded message, can be NULL.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_set_overflow_policy(ao_t ao, ao_policy_t policy, uint32_t timeout_ms,
+                           ao_overflow_handler_t ao_overflow_f);
+/**
+ * @brief Limit the rate of messages from a sender to a receiver.
+ *
+ * @note Token bucket checked by 'ao_send_message': it holds up to 'burst'
+ * tokens, refilled at 'rate_per_s', and each message takes one. Without a
+ * token the send returns AO_E_THROTTLED and nothing is posted. Up to
+ * AO_MAX_RATE_LIMITS pairs are limited at once, removed with 'rate_per_s' 0
+ * or when either AO is deinit.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO, NULL for the messages sent without sender.
+ * @param rate_per_s Messages per second, 0 removes the limit.
+ * @param burst Messages accepted at once after a quiet period.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_set_rate_limit(ao_t receiver, ao_t sender, uint16_t rate_per_s,
+                      uint8_t burst);
+/**
+ * @brief Limit the messages a single sender can have waiting for a receiver.
+ *
+ * @note Checked by 'ao_send_message', beyond the limit the send returns
+ * AO_E_THROTTLED, so one sender can not fill the inbox and starve the rest.
+ * Messages without sender share one budget. Coalescing receivers are not
+ * affected, their mailbox can not fill.
+ *
+ * @param receiver Receiver AO.
+ * @param max_pending Waiting messages allowed per sender, 0 disables it.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_set_admission(ao_t receiver, uint8_t max_pending);
+/**
+ * @brief Get the throttling counters of a receiver AO.
+ *
+ * @param ao Receiver AO.
+ * @param stats Where the counters are copied.
+ */
+void ao_get_throttle_stats(ao_t ao, ao_throttle_stats_t *stats);
+/**
+ * @brief Get the overflow counters of the inbox of an AO.
+ *
+ * @param ao AO instance.
+ * @param stats Where the counters are copied.
+ */
+void ao_get_overflow_stats(ao_t ao, ao_overflow_stats_t *stats);
+/**
+ * @brief Set the deadline budgets of the messages for an AO.
+ *
+ * @note Checked when its handler returns, from the AO task or 'ao_call'. A
+ * message waiting longer than 'wait_us' from its post, or whose handler runs
+ * longer than 'run_us', is counted, kept as the last miss and passed to
+ * 'ao_deadline_f'. Messages of 'ao_call' do not wait. The wait is measured
+ * from the event post time, for a coalescing AO from the first message of a
+ * burst. Events carry it with AO_EV_STAMP only, a wait budget is rejected
+ * without it. Times must stay below the cycle counter wrap.
+ *
+ * The AO core does not look into messages, budgets per signal are checked by
+ * 'ao_deadline_f' with the message it gets.
+ *
+ * @param ao AO instance.
+ * @param wait_us Budget from post to handler, in microseconds, 0 is off.
+ * @param run_us Budget of the handler, in microseconds, 0 is off.
+ * @param ao_deadline_f Called for every miss, can be NULL.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_set_deadline(ao_t ao, uint32_t wait_us, uint32_t run_us,
+                    ao_deadline_handler_t ao_deadline_f);
+/**
+ * @brief Get the deadline counters of an AO.
+ *
+ * @param ao AO instance.
+ * @param stats Where the counters are copied.
+ */
+void ao_get_deadline_stats(ao_t ao, ao_deadline_stats_t *stats);
+/**
+ * @brief Get the last message that missed a deadline of an AO.
+ *
+ * @param ao AO instance.
+ * @param ao_miss Where the miss is copied.
+ * @return int
+ * 				- AO_OK if no error.
+ * 				- AO_E_ARG if there was no miss.
+ */
+int ao_get_deadline_miss(ao_t ao, ao_deadline_miss_t *ao_miss);
+/**
+ * @brief Run the handler of a passive AO in the caller context.
+ *
+ * @note The message lives in the caller stack and is flagged AO_MSG_F_NO_FREE,
+ * so there is no allocation, queue nor context switch. The receiver must be
+ * created with (AO_OP_SYNC) and its handler must not block. Callers must not
+ * call the same AO from different tasks at once. A message pending in the
+ * mailbox of a coalescing receiver is dropped, the call is newer.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO, passed to the handler.
+ * @param ao_msg AO message pointer.
+ * @param ao_msg_size AO message size.
+ * @return int
+ * 				- AO_OK if no error.
+ * 				- AO_E_RECEIVER if the receiver is deinit or not (AO_OP_SYNC).
+ */
+int ao_call(ao_t receiver, ao_t sender, uint8_t *ao_msg, uint8_t ao_msg_size);
+/**
+ * @brief Get the id of an AO, its slot. Stable while it lives and the same
+ * for the same creation order.
+ *
+ * @param ao AO instance or NULL.
+ * @return uint8_t AO id, 0xFF for NULL.
+ */
+uint8_t ao_get_id(ao_t ao);
+/**
+ * @brief Get an AO by its id.
+ *
+ * @param id AO id.
+ * @return ao_t AO instance, NULL if the id is not alive.
+ */
+ao_t ao_get_by_id(uint8_t id);
+/**
+ * @brief Enter replay mode, the caller task becomes the replay task.
+ *
+ * @note Messages posted from the replay task skip the inboxes, rate limits and
+ * admission: they wait in a replay queue of AO_REPLAY_QUEUE_LEN messages and
+ * are handled by 'ao_replay_dispatch' in the replay task. Posts from other
+ * tasks fail with AO_E_OS, keep inputs quiet and AOs idle meanwhile.
+ *
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_replay_begin(void);
+/**
+ * @brief Run a message to completion in the replay task.
+ *
+ * @note The receiver handler runs, then the handlers of every message posted
+ * meanwhile, in post order, as if each AO took them at once. The AO clock of
+ * the replay task is virtual: post times and deadline waits read 'now', run
+ * times are measured.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO, passed to the handler.
+ * @param ao_msg AO message pointer.
+ * @param ao_msg_size AO message size.
+ * @param now Virtual cycle counter of the post.
+ * @return int
+ * 				- AO_OK if no error.
+ * 				- AO_E_FULL if messages posted by handlers were discarded.
+ */
+int ao_replay_dispatch(ao_t receiver, ao_t sender, const uint8_t *ao_msg,
+                       uint8_t ao_msg_size, uint32_t now);
+/**
+ * @brief Leave replay mode, messages still queued for the replay are lost.
+ */
+void ao_replay_end(void);
 /**
  * @brief Call the free message method of an AO.
  *
+ * @note Kept for compatibility, it does nothing with AO_MSG_F_NO_FREE messages,
+ * which are all of them.
+ *
  * @param ao AO instance.
  * @param ao_msg Pointer of AO message to be free.
  */
@@ -116,6 +419,8 @@ void ao_sender_free_method(ao_t ao, ao_msg_t *ao_msg);
 /**
  * @brief Generic free for an AO message.
  *
+ * @note Kept for compatibility, as 'ao_sender_free_method'.
+ *
  * @param ao_msg AO message.
  */
 void ao_generic_free_message(ao_msg_t *ao_msg);
@@ -0,0 +1,30 @@
+/*
+ * ao_bench.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_AO_BENCH_H_
+#define INC_AO_BENCH_H_
+
+/*< Run the AO benchmark once the scheduler starts */
+#define AO_BENCH_CONFIG_ENABLE (0)
+/*< Samples taken for each measure */
+#define AO_BENCH_CONFIG_SAMPLES (200)
+
+/**
+ * @brief Start the AO benchmark task.
+ *
+ * @note It measures, in DWT cycles, for a queue and a lock-free
+ * (AO_OP_LOCKFREE) inbox: the cost of ao_send_message alone (post) and the
+ * latency from ao_send_message to the handler of the AO task (dispatch). Then
+ * a context switch triggered by a task notification. Results are logged
+ * together with the RTOS heap placement (see LINKER_CONFIG_HEAP_IN_CCM), build
+ * once per placement to compare them. The task deletes itself when done.
+ *
+ * @note Does nothing unless AO_BENCH_CONFIG_ENABLE.
+ */
+void ao_bench_start(void);
+
+#endif /* INC_AO_BENCH_H_ */
@@ -11,13 +11,31 @@
 /* AO general configuration */
 
 /*< AO max message size to send */
-#define AO_MAX_MSG_SIZE (4)
+#define AO_MAX_MSG_SIZE (16)
+/*< AO message bytes carried by value in the inbox, larger ones are pooled */
+#define AO_EV_PAYLOAD_SIZE (4)
+/*< AO pooled messages waiting in inboxes at once */
+#define AO_MSG_POOL_SIZE (4)
 /*< AO max aditional data size */
 #define AO_MAX_DATA_SIZE (8)
 /*< AO max static object allowed */
 #define AO_MAX_OBJECTS (4)
-/*< AO max events received */
+/*< AO default events queued, see ao_config_t */
 #define AO_MAX_QUEUE_MSG (3)
+/*< AO token bucket rate limits set at once, see ao_set_rate_limit */
+#define AO_MAX_RATE_LIMITS (4)
+/*< AO events carry their post time (4 bytes more each), for wait budgets */
+#define AO_EV_STAMP (0)
+/*< AO event bytes, as copied into inboxes and queues */
+#define AO_EV_SIZE (8 + 4 * AO_EV_STAMP)
+/*< AO messages posted by handlers pending at once during a replay */
+#define AO_REPLAY_QUEUE_LEN (8)
+/*< AO lock-free inbox slots, must be a power of two */
+#define AO_INBOX_SIZE (4)
+/*< AO default task stack depth in words. See stack_monitor_report to size it */
+#define AO_TASK_STACK_SIZE (128)
+/*< AO default task priority, over the idle task one */
+#define AO_TASK_PRIORITY (1)
 
 /* AO option flags for initialize objects */
 
@@ -25,5 +43,20 @@
 #define AO_OP_NO_QUEUE (1 << 0)
 /*< AO does not create a task for events */
 #define AO_OP_NO_TASK (1 << 1)
+/*< AO inbox is a last-value-wins mailbox, pending messages are overwritten */
+#define AO_OP_COALESCE (1 << 2)
+/*< AO inbox is a lock-free ring, its task sleeps on a task notification */
+#define AO_OP_LOCKFREE (1 << 3)
+/*< AO handler can be run in the caller context by ao_call. Needs NO_TASK */
+#define AO_OP_SYNC (1 << 4)
+
+/* AO message flags */
+
+/*< Message storage is owned by the AO core, free methods skip it */
+#define AO_MSG_F_NO_FREE (1 << 0)
+/*< Message is a doorbell for a coalescing AO mailbox */
+#define AO_MSG_F_MBOX (1 << 1)
+/*< Message payload is in the AO message pool */
+#define AO_MSG_F_POOL (1 << 2)
 
 #endif /* INC_AO_DEF_H_ */
@@ -0,0 +1,142 @@
+/*
+ * ao_journal.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_AO_JOURNAL_H_
+#define INC_AO_JOURNAL_H_
+
+#include "ao_def.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*< Record the AO messages, functions do nothing without it. The host replay
+ * (tools/ao_replay_host) builds with it on */
+#ifndef AO_JOURNAL_CONFIG_ENABLE
+#define AO_JOURNAL_CONFIG_ENABLE (0)
+#endif
+/*< Journal entries, must be a power of two. 24 bytes each, in CCM RAM */
+#define AO_JOURNAL_CONFIG_ENTRIES (64)
+
+/*< AO id of no AO, e.g. a message without sender */
+#define AO_JOURNAL_NO_AO (0xFF)
+
+/*< Low bits of a journaled AO id hold its slot, the rest its generation */
+#define AO_JOURNAL_SLOT_BITS (4)
+/*< Journaled id of an AO: its slot and how many times it was created, the
+ * generation tells apart the AOs a slot held. It wraps at 16 */
+#define AO_JOURNAL_ID(slot, gen)                                               \
+  ((uint8_t)(((gen) << AO_JOURNAL_SLOT_BITS) | (slot)))
+#define AO_JOURNAL_SLOT(id)                                                    \
+  ((uint8_t)((id) & ((1U << AO_JOURNAL_SLOT_BITS) - 1U)))
+#define AO_JOURNAL_GEN(id) ((uint8_t)((id) >> AO_JOURNAL_SLOT_BITS))
+
+_Static_assert(AO_MAX_OBJECTS < AO_JOURNAL_SLOT(AO_JOURNAL_NO_AO),
+               "AO journal ids must not take the slot of no AO");
+
+/*< Posted outside any AO handler, e.g. by the button task. Replay feeds it */
+#define AO_JOURNAL_F_ROOT (1 << 0)
+/*< Run in the caller context by ao_call */
+#define AO_JOURNAL_F_CALL (1 << 1)
+
+/**
+ * @brief AO message as journaled, when it was accepted by the AO core.
+ *
+ */
+typedef struct {
+  uint32_t cyc;                     /*< Cycle counter when posted */
+  uint8_t sender;                   /*< Sender AO_JOURNAL_ID or NO_AO */
+  uint8_t receiver;                 /*< Receiver AO_JOURNAL_ID */
+  uint8_t size;                     /*< Payload size */
+  uint8_t flags;                    /*< AO_JOURNAL_F_* */
+  uint8_t payload[AO_MAX_MSG_SIZE]; /*< Payload, zero past its size */
+} ao_journal_entry_t;
+
+_Static_assert(sizeof(ao_journal_entry_t) == 8 + AO_MAX_MSG_SIZE,
+               "AO journal entries must stay compact");
+
+/**
+ * @brief Replay results. Times are in DWT cycles.
+ *
+ */
+typedef struct {
+  uint32_t roots;       /*< Messages fed to their handlers */
+  uint32_t skipped;     /*< Messages for earlier AOs or not alive ones */
+  uint32_t nested;      /*< Messages posted again by the handlers */
+  bool diverged;        /*< Handlers posted something else than journaled */
+  uint32_t diverged_at; /*< Entry of the first difference */
+  uint32_t run_total;   /*< Handlers run time, nested messages included */
+  uint32_t run_max;     /*< Worst handlers run time of a fed message */
+} ao_journal_replay_stats_t;
+
+/**
+ * @brief Empty the journal and record again.
+ *
+ * @note Every message accepted by ao_send_message or ao_call is journaled,
+ * oldest ones are overwritten. Dump the 'ao_journal_buffer' symbol from the
+ * debugger, its capacity and head words then the entries, and replay it with
+ * tools/ao_replay_host. Or copy it with 'ao_journal_read'.
+ */
+void ao_journal_start(void);
+/**
+ * @brief Stop recording, e.g. when a fault is seen, to keep what led to it.
+ */
+void ao_journal_stop(void);
+/**
+ * @brief Journal a message accepted by the AO core.
+ *
+ * @note Called by the AO core, not from interrupts.
+ *
+ * @param sender Sender AO_JOURNAL_ID or AO_JOURNAL_NO_AO.
+ * @param receiver Receiver AO_JOURNAL_ID.
+ * @param ao_msg Message payload.
+ * @param ao_msg_size Message size, up to AO_MAX_MSG_SIZE.
+ * @param flags AO_JOURNAL_F_*.
+ */
+void ao_journal_put(uint8_t sender, uint8_t receiver, const uint8_t *ao_msg,
+                    uint8_t ao_msg_size, uint8_t flags);
+/**
+ * @brief Copy the journal, oldest entry first.
+ *
+ * @param entries Where entries are copied.
+ * @param max Entries that fit in 'entries'.
+ * @return uint32_t Entries copied.
+ */
+uint32_t ao_journal_read(ao_journal_entry_t *entries, uint32_t max);
+/**
+ * @brief Feed journaled messages into the handlers of fresh AOs.
+ *
+ * @note Only the root messages (AO_JOURNAL_F_ROOT) are fed, in their order,
+ * each one run to completion with what its handlers post (see
+ * 'ao_replay_dispatch'). The AO clock is virtual, it reads the journaled
+ * post time, while run times are measured. The rest of the entries are the
+ * expected output: what the handlers post is checked against them in order,
+ * the first difference is reported.
+ *
+ * Only the last generation journaled of each slot is replayed, messages of
+ * the AOs a slot held before are skipped. Its AOs must be fresh, created as
+ * they were, in the same slots and from the same state, so the replay runs
+ * on the host (tools/ao_replay_host) with the led port faked. The replay is
+ * exact if the journal holds them from their first message. Inputs must be
+ * quiet, other tasks can not post meanwhile. Messages discarded in the field
+ * by an overflow policy are handled in the replay. The journal is stopped
+ * during the replay and restarted after, pass a copy of it.
+ *
+ * @param entries Journaled messages, oldest first.
+ * @param count Number of entries.
+ * @param stats Where the results are copied.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_journal_replay(const ao_journal_entry_t *entries, uint32_t count,
+                      ao_journal_replay_stats_t *stats);
+/**
+ * @brief Log the results of a replay, in microseconds.
+ *
+ * @param stats Replay results.
+ */
+void ao_journal_report(const ao_journal_replay_stats_t *stats);
+
+#endif /* INC_AO_JOURNAL_H_ */
@@ -0,0 +1,76 @@
+/*
+ * ao_state.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_AO_STATE_H_
+#define INC_AO_STATE_H_
+
+#include "cmsis_os.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*< Values a published state can take, one event group bit each */
+#define AO_STATE_MAX_VALUES (24)
+/*< Event group bit of a state value, for ao_state_wait masks */
+#define AO_STATE_BIT(value) (1UL << (value))
+/*< Timeout of ao_state_wait that never expires */
+#define AO_STATE_WAIT_FOREVER (UINT32_MAX)
+
+/**
+ * @brief State published by an AO for other tasks.
+ *
+ * @note The value is a single word, written by the owner AO and read by
+ * anyone without locks. Its event group keeps the bit of the current value
+ * set and the others clear, so tasks can block until a value is reached.
+ */
+typedef struct {
+  volatile uint32_t value;   /*< Last published value */
+  EventGroupHandle_t events; /*< Bit of the current value */
+} ao_state_t;
+
+/**
+ * @brief Initialize a published state and publish its first value.
+ *
+ * @note The event group is created on the first call only, so the state
+ * outlives the AO that publishes it and can be initialized again each time
+ * the AO is created. Task context only.
+ *
+ * @param state Published state.
+ * @param value First value, below AO_STATE_MAX_VALUES.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_state_init(ao_state_t *state, uint32_t value);
+/**
+ * @brief Publish a new value. Owner AO only, task context.
+ *
+ * @note The value is visible to 'ao_state_get' before the tasks waiting for
+ * it are woken.
+ *
+ * @param state Published state.
+ * @param value New value, below AO_STATE_MAX_VALUES.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+int ao_state_publish(ao_state_t *state, uint32_t value);
+/**
+ * @brief Read the last published value, without locks.
+ *
+ * @param state Published state.
+ * @return uint32_t Value.
+ */
+uint32_t ao_state_get(const ao_state_t *state);
+/**
+ * @brief Block until the published value is one of a set.
+ *
+ * @param state Published state.
+ * @param mask AO_STATE_BIT of every value waited for.
+ * @param timeout_ms Wait, in milliseconds, or AO_STATE_WAIT_FOREVER.
+ * @return true if one of the values is published, false on timeout.
+ */
+bool ao_state_wait(ao_state_t *state, uint32_t mask, uint32_t timeout_ms);
+
+#endif /* INC_AO_STATE_H_ */
@@ -102,6 +102,11 @@ extern "C" {
 #define LED_ON			GPIO_PIN_SET
 #define LED_OFF			GPIO_PIN_RESET
 
+/* Led A (PB0) can be driven by TIM3 channel 3 for PWM patterns */
+#define LED_A_PWM_TIM		TIM3
+#define LED_A_PWM_CCR		CCR3
+#define LED_A_PWM_AF		GPIO_AF2_TIM3
+
 #endif
 
 /* STM32 Discovery Kits */
@@ -0,0 +1,73 @@
+/*
+ * button_gesture.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_BUTTON_GESTURE_H_
+#define INC_BUTTON_GESTURE_H_
+
+#include "button_scan.h"
+#include <stdint.h>
+
+/*< Max gestures reported by a single update */
+#define BUTTON_GESTURE_MAX_EVENTS (4)
+
+/**
+ * @brief Gesture types.
+ */
+typedef enum {
+  BUTTON_GESTURE_NONE = 0,
+  BUTTON_GESTURE_PULSE,  /*< Released after pulse time */
+  BUTTON_GESTURE_SHORT,  /*< Released after short time */
+  BUTTON_GESTURE_LONG,   /*< Held for long time, fired while still held */
+  BUTTON_GESTURE_REPEAT, /*< Auto repeat while held after a long gesture */
+  BUTTON_GESTURE_DOUBLE, /*< Two pulses inside the double click window */
+  BUTTON_GESTURE_CHORD,  /*< Several buttons pressed inside the chord window */
+} button_gesture_type_t;
+
+/**
+ * @brief Gesture recognizer configuration. Times in milliseconds.
+ */
+typedef struct {
+  uint16_t pulse_ms;        /*< Min press time of a pulse */
+  uint16_t short_ms;        /*< Min press time of a short press */
+  uint16_t long_ms;         /*< Press time that fires a long gesture */
+  uint16_t repeat_delay_ms; /*< Time after long until the first repeat */
+  uint16_t repeat_ms;       /*< Repeat period, 0 disables auto repeat */
+  uint16_t double_ms;       /*< Double click window, 0 disables it */
+  uint16_t chord_ms;        /*< Max skew between chord presses, 0 disables */
+} button_gesture_cfg_t;
+
+typedef struct {
+  button_gesture_type_t type; /*< Gesture type */
+  button_mask_t buttons;      /*< Button, or buttons of a chord */
+  uint16_t repeat;            /*< Repeat count of a repeat gesture */
+} button_gesture_ev_t;
+
+/**
+ * @brief Initialize the gesture recognizer.
+ *
+ * @note With double click enabled, a pulse is only reported once the double
+ * click window expires. Disable it to report pulses on release.
+ *
+ * @param cfg Recognizer configuration. It is copied.
+ */
+void button_gesture_init(const button_gesture_cfg_t *cfg);
+/**
+ * @brief Feed the debounced buttons into the recognizer.
+ *
+ * @note Gestures are reported as soon as they are decidable: long and repeat
+ * fire while the button is held, short fires on release.
+ *
+ * @param scan Debounced buttons from the scanner.
+ * @param period_ms Time elapsed since the previous update.
+ * @param ev Where gestures are returned.
+ * @param max_ev Max gestures to return.
+ * @return uint8_t Number of gestures returned.
+ */
+uint8_t button_gesture_update(const button_scan_ev_t *scan, uint16_t period_ms,
+                              button_gesture_ev_t *ev, uint8_t max_ev);
+
+#endif /* INC_BUTTON_GESTURE_H_ */
@@ -0,0 +1,74 @@
+/*
+ * button_scan.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_BUTTON_SCAN_H_
+#define INC_BUTTON_SCAN_H_
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*< Max buttons handled by the scanner */
+#define BUTTON_SCAN_MAX_BUTTONS (8)
+/*< Max different GPIO ports among the buttons */
+#define BUTTON_SCAN_MAX_PORTS (3)
+
+/*< Button mask bit for the button in position 'n' of the scanner */
+#define BUTTON_MASK(n) ((button_mask_t)(1U << (n)))
+
+/*< Button mask. Bit 'n' refers to button 'n' of the scanner */
+typedef uint8_t button_mask_t;
+
+typedef struct {
+  GPIO_TypeDef *port; /*< Button port */
+  uint16_t pin;       /*< Button pin */
+} button_pin_t;
+
+typedef struct {
+  button_mask_t pressed;  /*< Buttons pressed since the last scan */
+  button_mask_t released; /*< Buttons released since the last scan */
+  button_mask_t state;    /*< Debounced buttons currently pressed */
+  button_mask_t settling; /*< Buttons whose input differs from their state */
+} button_scan_ev_t;
+
+/**
+ * @brief Initialize the button scanner.
+ *
+ * @note Buttons sharing a port are sampled with a single port read and all of
+ * them are debounced in parallel with 2-bit vertical counters: a change is
+ * accepted after 4 consecutive equal samples.
+ * A button wired to the pin of a previous button is an alias of it and never
+ * reports events, so one physical button is never seen as two.
+ *
+ * @param buttons Buttons to scan. Button 'n' is reported in bit 'n'.
+ * @param count Number of buttons (up to BUTTON_SCAN_MAX_BUTTONS).
+ * @return int
+ * 				- 0 if no error.
+ * 				- -1 if the buttons can not be handled.
+ */
+int button_scan_init(const button_pin_t *buttons, uint8_t count);
+/**
+ * @brief Sample and debounce every button.
+ *
+ * @note Call it periodically. The debounce time is 4 times the period.
+ *
+ * @param ev Where the debounced events are returned.
+ * @return true if any button was pressed or released.
+ */
+bool button_scan_update(button_scan_ev_t *ev);
+/**
+ * @brief Replace the button inputs by scripted ones, e.g. to measure the
+ * response to a known sequence of presses.
+ *
+ * @note Injected inputs are debounced as the pins are.
+ *
+ * @param enable True to sample 'pressed', false to sample the pins again.
+ * @param pressed Buttons seen as pressed by the next scans.
+ */
+void button_scan_inject(bool enable, button_mask_t pressed);
+
+#endif /* INC_BUTTON_SCAN_H_ */
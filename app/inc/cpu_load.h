@@ -0,0 +1,54 @@
+/*
+ * cpu_load.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_CPU_LOAD_H_
+#define INC_CPU_LOAD_H_
+
+#include <stdint.h>
+
+#define CPU_LOAD_CONFIG_ENABLE (1)
+/*< Time over which the idle time is summed into one load sample */
+#define CPU_LOAD_CONFIG_WINDOW_MS (500)
+/*< Smoothing of the samples, each one weighs 1 / 2^shift in the average */
+#define CPU_LOAD_CONFIG_EWMA_SHIFT (3)
+/*< Longest gap between idle hook calls still counted as idle, in cycles */
+#define CPU_LOAD_CONFIG_GAP_CYCLES (2000)
+
+/**
+ * @brief CPU load, in per mille of the CPU time.
+ *
+ */
+typedef struct {
+  uint16_t last; /*< Last window */
+  uint16_t avg;  /*< Smoothed over the last windows */
+  uint16_t peak; /*< Highest window since the last report */
+} cpu_load_t;
+
+/**
+ * @brief Count idle time. Call it from the idle hook.
+ *
+ * @note The time between two calls is idle when shorter than
+ * CPU_LOAD_CONFIG_GAP_CYCLES. A longer one had other tasks running, only the
+ * shortest gap seen, the cost of one idle loop, is counted idle from it.
+ * Interrupts shorter than the gap are counted idle.
+ */
+void cpu_load_idle(void);
+/**
+ * @brief Get the CPU load.
+ *
+ * @note Windows with no idle time at all end here, as the idle hook does not
+ * run to end them.
+ *
+ * @param load Where the load is written.
+ */
+void cpu_load_get(cpu_load_t *load);
+/**
+ * @brief Log the CPU load and restart the peak.
+ */
+void cpu_load_report(void);
+
+#endif /* INC_CPU_LOAD_H_ */
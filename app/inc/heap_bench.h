@@ -0,0 +1,31 @@
+/*
+ * heap_bench.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_HEAP_BENCH_H_
+#define INC_HEAP_BENCH_H_
+
+/*< Run the heap benchmark at start up */
+#define HEAP_BENCH_CONFIG_ENABLE (0)
+/*< Blocks kept alive at once by the workload */
+#define HEAP_BENCH_CONFIG_SLOTS (24)
+/*< Allocations and frees measured */
+#define HEAP_BENCH_CONFIG_ROUNDS (2000)
+
+/**
+ * @brief Measure pvPortMalloc and vPortFree of the selected RTOS heap.
+ *
+ * @note The workload mimics the AO churn: many small blocks mixed with
+ * queue, TCB and stack sized ones from UI teardown and re-init, picked at
+ * random so the heap fragments. Worst and average cycles are logged, build
+ * once per configHEAP_SCHEME to compare them.
+ *
+ * @note Call it before the scheduler starts, interrupts are masked then and
+ * do not disturb the measures. Does nothing unless HEAP_BENCH_CONFIG_ENABLE.
+ */
+void heap_bench_run(void);
+
+#endif /* INC_HEAP_BENCH_H_ */
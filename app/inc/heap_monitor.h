@@ -0,0 +1,89 @@
+/*
+ * heap_monitor.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_HEAP_MONITOR_H_
+#define INC_HEAP_MONITOR_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HEAP_MONITOR_CONFIG_ENABLE (1)
+/*< Allocation records kept in the trace ring */
+#define HEAP_MONITOR_CONFIG_RING_SIZE (32)
+/*< Live blocks followed for leak reports */
+#define HEAP_MONITOR_CONFIG_MAX_LIVE (32)
+
+typedef enum {
+  HEAP_MONITOR_OP_MALLOC,
+  HEAP_MONITOR_OP_FREE,
+  HEAP_MONITOR_OP_FAIL, /*< Allocation returned NULL */
+} heap_monitor_op_t;
+
+typedef struct {
+  uint32_t timestamp; /*< DWT cycle counter */
+  void *addr;         /*< Block returned to or by the caller */
+  void *caller;       /*< Return address into the caller */
+  uint16_t size;      /*< Block size, including the allocator header */
+  uint8_t op;         /*< heap_monitor_op_t */
+} heap_monitor_record_t;
+
+typedef struct {
+  size_t free_bytes;         /*< Free bytes now */
+  size_t min_free_bytes;     /*< Lowest free bytes ever */
+  size_t largest_free_block; /*< Largest allocation that could succeed */
+  size_t free_blocks;        /*< Number of free blocks */
+  uint32_t allocs;           /*< Successful allocations */
+  uint32_t frees;            /*< Frees */
+  uint32_t fails;            /*< Failed allocations */
+  uint16_t live_blocks;      /*< Blocks allocated and not freed */
+  uint8_t fragmentation;     /*< 100 * (1 - largest / free), 0 is no loss */
+} heap_monitor_metrics_t;
+
+/**
+ * @brief Get the heap metrics.
+ *
+ * @param metrics Where metrics are returned.
+ */
+void heap_monitor_get_metrics(heap_monitor_metrics_t *metrics);
+/**
+ * @brief Copy the trace ring, oldest record first.
+ *
+ * @param records Where records are copied.
+ * @param max Max records to copy.
+ * @return uint16_t Number of records copied.
+ */
+uint16_t heap_monitor_get_records(heap_monitor_record_t *records,
+                                  uint16_t max);
+/**
+ * @brief Log the heap metrics and every live block with its caller.
+ *
+ * @note Call it when the heap should be back to a known state, e.g. after a
+ * teardown, so left over blocks stand out as leaks.
+ */
+void heap_monitor_report(void);
+/**
+ * @brief Stop or resume following the heap.
+ *
+ * @note Allocations and frees made while paused are neither recorded nor
+ * followed, e.g. to time the heap without the hooks. Free every block
+ * allocated meanwhile before resuming.
+ *
+ * @param pause True to pause, false to resume.
+ */
+void heap_monitor_pause(bool pause);
+
+/**
+ * @brief traceMALLOC hook. Runs with the scheduler suspended.
+ */
+void heap_monitor_on_malloc(void *addr, size_t size, void *caller);
+/**
+ * @brief traceFREE hook. Runs with the scheduler suspended.
+ */
+void heap_monitor_on_free(void *addr, size_t size, void *caller);
+
+#endif /* INC_HEAP_MONITOR_H_ */
@@ -0,0 +1,46 @@
+/*
+ * heap_regions.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_HEAP_REGIONS_H_
+#define INC_HEAP_REGIONS_H_
+
+#include <stddef.h>
+
+/**
+ * @brief Memory regions of the RTOS heap, in address order.
+ */
+typedef enum {
+  HEAP_REGION_CCM = 0, /*< CPU only, zero wait states. Stacks, TCBs, queues */
+  HEAP_REGION_SRAM,    /*< SRAM1/2/3, reachable by DMA */
+  HEAP_REGION_MAX,
+} heap_region_t;
+
+/**
+ * @brief Hand the RAM left by the linker to the RTOS heap.
+ *
+ * @note With heap_5 the heap is made of the end of CCM RAM and the main SRAM
+ * between the newlib heap and the MSP stack, so it grows with whatever the
+ * application does not place statically. Must be called before anything is
+ * allocated from the RTOS heap. Does nothing with other heap schemes.
+ */
+void heap_regions_init(void);
+
+/**
+ * @brief Allocate from a given region of the RTOS heap.
+ *
+ * @note pvPortMalloc takes the first free block in address order, so kernel
+ * objects fill CCM before spilling to SRAM. Use this for buffers that need
+ * a specific memory, e.g. HEAP_REGION_SRAM for DMA. Free with vPortFree.
+ *
+ * @param size Bytes wanted.
+ * @param region Region to allocate from.
+ * @return void* Block, NULL if it does not fit in the region or the heap
+ * scheme can not honour the region.
+ */
+void *heap_regions_malloc(size_t size, heap_region_t region);
+
+#endif /* INC_HEAP_REGIONS_H_ */
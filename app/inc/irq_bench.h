@@ -0,0 +1,38 @@
+/*
+ * irq_bench.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_IRQ_BENCH_H_
+#define INC_IRQ_BENCH_H_
+
+/*< Run the interrupt and context switch benchmark once the scheduler starts */
+#define IRQ_BENCH_CONFIG_ENABLE (0)
+/*< Samples taken for each measure, one per TIM2 period (2 ms) */
+#define IRQ_BENCH_CONFIG_SAMPLES (200)
+
+/**
+ * @brief Start the interrupt benchmark task.
+ *
+ * @note It measures, in DWT cycles:
+ * - entry: from the TIM2 update event to its handler, read from the TIM2
+ *   counter, so in steps of one timer count (4 cycles).
+ * - queue: from the handler to a task woken by xQueueSendFromISR.
+ * - notify: from the handler to a task woken by vTaskNotifyGiveFromISR.
+ * - switch: from a task yielding to the next one of the same priority.
+ * Each one idle, with the application alone, then loaded by a task that
+ * copies memory inside and outside kernel critical sections, which mask TIM2
+ * (configMAX_SYSCALL_INTERRUPT_PRIORITY). Results are logged as a table. The
+ * task deletes itself when done.
+ *
+ * @note Does nothing unless IRQ_BENCH_CONFIG_ENABLE.
+ */
+void irq_bench_start(void);
+/**
+ * @brief TIM2 interrupt hook. First line of the handler.
+ */
+void irq_bench_isr(void);
+
+#endif /* INC_IRQ_BENCH_H_ */
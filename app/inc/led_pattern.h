@@ -0,0 +1,91 @@
+/*
+ * led_pattern.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_LED_PATTERN_H_
+#define INC_LED_PATTERN_H_
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*< Max steps of a compiled pattern */
+#define LED_PATTERN_MAX_STEPS (128)
+
+/**
+ * @brief Pattern identifiers.
+ */
+typedef enum {
+  LED_PATTERN_NONE = 0, /*< No pattern, leds are steady */
+  LED_PATTERN_BLINK,    /*< 1 Hz blink */
+  LED_PATTERN_SOS,      /*< Morse SOS */
+  LED_PATTERN_BREATHE,  /*< PWM breathe (only on PWM capable leds) */
+  LED_PATTERN__N,
+} led_pattern_id_t;
+
+/**
+ * @brief How the steps of a pattern are played.
+ */
+typedef enum {
+  LED_PATTERN_KIND_ONOFF = 0, /*< Each step is 0 (off) or 1 (on) */
+  LED_PATTERN_KIND_PWM,       /*< Each step is a brightness (0-255) */
+} led_pattern_kind_t;
+
+/**
+ * @brief Pattern descriptor.
+ */
+typedef struct {
+  led_pattern_kind_t kind; /*< Kind of steps */
+  uint16_t step_ms;        /*< Duration of every step */
+  bool mirror;             /*< Play steps forward and then backward */
+  uint8_t steps_count;     /*< Number of steps */
+  const uint8_t *steps;    /*< Steps table */
+} led_pattern_t;
+
+/**
+ * @brief Initialize the pattern engine hardware.
+ *
+ * @note The patterns are played by a hardware timer whose update event
+ * triggers a circular DMA transfer into the GPIO BSRR register (or into a PWM
+ * compare register). Once a pattern is started the CPU is not involved.
+ */
+void led_pattern_init(void);
+/**
+ * @brief Get a pattern descriptor.
+ *
+ * @param id Pattern identifier.
+ * @return const led_pattern_t* Pattern descriptor, NULL if none.
+ */
+const led_pattern_t *led_pattern_get(led_pattern_id_t id);
+/**
+ * @brief Play a pattern on a set of pins of a port.
+ *
+ * @note The pattern replaces any pattern previously played. PWM patterns can
+ * only be played on a single PWM capable led.
+ *
+ * @param id Pattern identifier. LED_PATTERN_NONE stops the engine.
+ * @param port Leds port.
+ * @param pins Leds pins.
+ * @return int
+ * 				- 0 if no error.
+ * 				- -1 if the pattern can not be played on those pins.
+ */
+int led_pattern_play(led_pattern_id_t id, GPIO_TypeDef *port, uint16_t pins);
+/**
+ * @brief Stop the pattern being played, if any.
+ *
+ * @note Pins are left in the last state written by the pattern.
+ */
+void led_pattern_stop(void);
+/**
+ * @brief Get the pins being animated in a port.
+ *
+ * @param port Leds port.
+ * @return uint16_t Pins of the port driven by the engine, 0 if none.
+ */
+uint16_t led_pattern_pins(GPIO_TypeDef *port);
+
+#endif /* INC_LED_PATTERN_H_ */
@@ -0,0 +1,59 @@
+/*
+ * led_pattern_port.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_LED_PATTERN_PORT_H_
+#define INC_LED_PATTERN_PORT_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Hardware layer of the led pattern engine. The engine only compiles patterns
+ * into words and hands them to these functions, so another implementation
+ * (e.g. a fake timer/GPIO) can replace this layer without touching the engine.
+ * tools/led_pattern_host plays the patterns on the host with one.
+ */
+
+/**
+ * @brief Initialize the step timer and the DMA stream.
+ */
+void led_pattern_port_init(void);
+/**
+ * @brief Start writing 'src' words into 'dst', one word per step, forever.
+ *
+ * @param dst Destination register.
+ * @param src Words to write. Must be DMA reachable (not CCM RAM).
+ * @param count Number of words.
+ * @param step_ms Step duration.
+ */
+void led_pattern_port_start(volatile uint32_t *dst, const uint32_t *src,
+                            uint16_t count, uint16_t step_ms);
+/**
+ * @brief Stop the step timer and the DMA stream.
+ */
+void led_pattern_port_stop(void);
+/**
+ * @brief Route a led pin to its PWM channel.
+ *
+ * @param port Led port.
+ * @param pin Led pin.
+ * @return volatile uint32_t* PWM compare register, NULL if not PWM capable.
+ */
+volatile uint32_t *led_pattern_port_pwm_attach(GPIO_TypeDef *port,
+                                               uint16_t pin);
+/**
+ * @brief Route back the PWM led pin to GPIO output.
+ */
+void led_pattern_port_pwm_detach(void);
+/**
+ * @brief Get the PWM compare value of a full brightness led.
+ *
+ * @return uint32_t PWM period in timer counts.
+ */
+uint32_t led_pattern_port_pwm_period(void);
+
+#endif /* INC_LED_PATTERN_PORT_H_ */
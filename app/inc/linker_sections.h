@@ -0,0 +1,21 @@
+/*
+ * linker_sections.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_LINKER_SECTIONS_H_
+#define INC_LINKER_SECTIONS_H_
+
+/*< Place the RTOS heap in CCM RAM, with every AO stack, TCB and queue.
+ * heap_4 and TLSF only, heap_5 spans CCM and SRAM */
+#define LINKER_CONFIG_HEAP_IN_CCM (1)
+
+/*< Zero initialized object in CCM RAM: zero wait states, no DMA contention.
+ * Only the CPU reaches it, never place DMA buffers here */
+#define LINKER_SECTION_CCM __attribute__((section(".ccmbss")))
+/*< Zero initialized object kept in main SRAM, reachable by DMA */
+#define LINKER_SECTION_DMA __attribute__((section(".bss.dma")))
+
+#endif /* INC_LINKER_SECTIONS_H_ */
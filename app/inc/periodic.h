@@ -0,0 +1,82 @@
+/*
+ * periodic.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_PERIODIC_H_
+#define INC_PERIODIC_H_
+
+#include "cmsis_os.h"
+#include <stdint.h>
+
+/**
+ * @brief Periodic activation counters. Times are in DWT cycles.
+ *
+ */
+typedef struct {
+  uint32_t activations;   /*< Releases handled */
+  uint32_t overruns;      /*< Activations that ended after the next release */
+  uint32_t skipped;       /*< Releases lost to overruns */
+  int32_t release_min;    /*< Earliest start from its release */
+  int32_t release_max;    /*< Latest start from its release */
+  uint32_t response_last; /*< Last time from release to periodic_wait */
+  uint32_t response_max;  /*< Worst time from release to periodic_wait */
+} periodic_stats_t;
+
+/**
+ * @brief Periodic activation of a task, owned by the task.
+ *
+ */
+typedef struct {
+  TickType_t period;      /*< Period in ticks */
+  TickType_t last_wake;   /*< Release tick of the current activation */
+  TickType_t anchor_tick; /*< Release tick of the first activation */
+  uint32_t anchor_cyc;    /*< Cycle counter at the first activation */
+  uint32_t cyc_per_tick;  /*< Cycles per tick */
+  uint32_t release_cyc;   /*< Ideal cycle counter at the current release */
+  periodic_stats_t stats;
+} periodic_t;
+
+/**
+ * @brief Start a periodic activation, the first one is released on the
+ * next tick.
+ *
+ * @note Call it from the task, it waits for the tick edge.
+ *
+ * @param p Periodic activation.
+ * @param period_ms Period in milliseconds, at least one tick.
+ */
+void periodic_init(periodic_t *p, uint32_t period_ms);
+/**
+ * @brief End the current activation and block until the next release.
+ *
+ * @note Releases are absolute (vTaskDelayUntil), so the time the body takes,
+ * including waits for shared resources, does not shift the next one. An
+ * activation that ends past the next release is an overrun, the releases
+ * already missed are skipped to keep the phase instead of running back to
+ * back. Release jitter is the cycle counter at wake up against the ideal
+ * release, taken from the first one.
+ *
+ * A periodic AO is driven by posting its message from a periodic task.
+ *
+ * @param p Periodic activation.
+ */
+void periodic_wait(periodic_t *p);
+/**
+ * @brief Get the counters of a periodic activation.
+ *
+ * @param p Periodic activation.
+ * @param stats Where the counters are copied.
+ */
+void periodic_get_stats(const periodic_t *p, periodic_stats_t *stats);
+/**
+ * @brief Log the counters of a periodic activation, in microseconds.
+ *
+ * @param p Periodic activation.
+ * @param name Name for the log.
+ */
+void periodic_report(const periodic_t *p, const char *name);
+
+#endif /* INC_PERIODIC_H_ */
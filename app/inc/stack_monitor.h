@@ -0,0 +1,57 @@
+/*
+ * stack_monitor.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_STACK_MONITOR_H_
+#define INC_STACK_MONITOR_H_
+
+#include "cmsis_os.h"
+#include <stdint.h>
+
+#define STACK_MONITOR_CONFIG_ENABLE (1)
+/*< Max tasks followed by the monitor */
+#define STACK_MONITOR_CONFIG_MAX_TASKS (8)
+/*< Min time between two samples of the idle hook */
+#define STACK_MONITOR_CONFIG_PERIOD_MS (100)
+/*< Margin added over the peak use in the recommended size, in percent */
+#define STACK_MONITOR_CONFIG_MARGIN_PCT (25)
+/*< Free words under which a task is flagged in the report */
+#define STACK_MONITOR_CONFIG_LOW_WORDS (16)
+
+/**
+ * @brief Follow the stack of a task.
+ *
+ * @note A task registered with the name of a previously unregistered task
+ * takes its entry and keeps its peak, so tasks created and deleted over and
+ * over are reported as one.
+ *
+ * @param task Task handle.
+ * @param name Task name. It is copied.
+ * @param depth Stack depth given to xTaskCreate, in words.
+ */
+void stack_monitor_register(TaskHandle_t task, const char *name,
+                            uint16_t depth);
+/**
+ * @brief Stop following a task. Call it before the task is deleted.
+ *
+ * @param task Task handle.
+ */
+void stack_monitor_unregister(TaskHandle_t task);
+/**
+ * @brief Sample the high water mark of every followed task.
+ */
+void stack_monitor_sample(void);
+/**
+ * @brief Sample from the idle hook, at most once every
+ * STACK_MONITOR_CONFIG_PERIOD_MS.
+ */
+void stack_monitor_idle(void);
+/**
+ * @brief Log the peak use and the recommended stack size of every task.
+ */
+void stack_monitor_report(void);
+
+#endif /* INC_STACK_MONITOR_H_ */
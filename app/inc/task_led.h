@@ -45,31 +45,64 @@ extern "C" {
 #include "ao_api.h"
 #include "board.h"
 #include "cmsis_os.h"
+#include "led_pattern.h"
 #include <stdint.h>
 
 /********************** macros ***********************************************/
 
+/*< Max leds driven by a led group AO */
+#define AO_LED_GROUP_MAX_LEDS (8)
+/*< Max different GPIO ports inside a led group AO */
+#define AO_LED_GROUP_MAX_PORTS (3)
+/*< Max led group AOs alive at the same time */
+#define AO_LED_GROUP_MAX_INSTANCES (1)
+
+/*< Led group mask bit for the led in position 'n' of the group */
+#define AO_LED_MASK(n) ((ao_led_mask_t)(1U << (n)))
+
 /********************** typedef **********************************************/
 
-typedef enum {
-  AO_LED_MESSAGE_ON,
-  AO_LED_MESSAGE_OFF,
-  AO_LED_MESSAGE_BLINK,
-  AO_LED_MESSAGE__N,
-} ao_led_message_t;
+/*< Led group mask. Bit 'n' set means led 'n' of the group must be on */
+typedef uint8_t ao_led_mask_t;
+
+typedef struct {
+  ao_led_mask_t mask; /*< Leds to turn on, the rest are turned off */
+  uint8_t pattern;    /*< led_pattern_id_t played by the mask leds */
+} ao_led_group_msg_t;
+
+typedef struct {
+  GPIO_TypeDef *led_port; /*< Led port */
+  uint16_t led_pin;       /*< Led pin */
+} ao_led_pin_t;
 
 /********************** external data declaration ****************************/
 
 /********************** external functions declaration ***********************/
 
 /**
- * @brief Initialize AO led.
+ * @brief Initialize AO led group.
+ *
+ * @note The group receives an 'ao_led_group_msg_t' with the on/off target of
+ * every led. All the leds sharing a port are updated with a single BSRR write,
+ * and ports whose leds already match the target are not written at all. The AO
+ * coalesces pending messages, so only the latest mask is applied. It also
+ * accepts 'ao_call' to be updated right away from the caller task.
  *
- * @param led_port Led port.
- * @param led_pin Led pin.
+ * If the message carries a pattern, the mask leds of the first port with leds
+ * in the mask are handed to the led pattern engine, which animates them by
+ * DMA without waking up the AO.
+ *
+ * @param leds Leds of the group. Led 'n' is driven by bit 'n' of the mask.
+ * @param leds_count Number of leds (up to AO_LED_GROUP_MAX_LEDS).
  * @return ao_t AO instance returned if Ok.
  */
-ao_t ao_led_init(GPIO_TypeDef *led_port, uint16_t led_pin);
+ao_t ao_led_group_init(const ao_led_pin_t *leds, uint8_t leds_count);
+/**
+ * @brief Deinit an AO led group and release its descriptor.
+ *
+ * @param ao AO led group instance.
+ */
+void ao_led_group_deinit(ao_t ao);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
@@ -65,6 +65,7 @@ typedef enum {
   AO_UI_LED_RED_ON,   /*< UI red led is on*/
   AO_UI_LED_GREEN_ON, /*< UI green led is on*/
   AO_UI_LED_BLUE_ON,  /*< UI blue led is on*/
+  AO_UI_STOPPING,     /*< UI being destroyed, not valid to use */
 } ao_ui_state_t;
 
 /********************** external data declaration ****************************/
@@ -82,9 +83,20 @@ ao_t ao_ui_init(void);
 /**
  * @brief Get AO UI state.
  *
+ * @note The state is published by the UI AO, any task can read it without
+ * locks.
+ *
  * @return ao_ui_state_t UI state.
  */
 ao_ui_state_t ao_ui_get_state(void);
+/**
+ * @brief Block until the AO UI reaches a state.
+ *
+ * @param state UI state.
+ * @param timeout_ms Wait, in milliseconds, or AO_STATE_WAIT_FOREVER.
+ * @return true if the state is reached, false on timeout.
+ */
+bool ao_ui_wait_state(ao_ui_state_t state, uint32_t timeout_ms);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
@@ -0,0 +1,119 @@
+/*
+ * trace_format.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_TRACE_FORMAT_H_
+#define INC_TRACE_FORMAT_H_
+
+/*
+ * Binary format of the trace recorder, shared with the host decoder. Plain C
+ * with fixed size types only, little endian as the target.
+ *
+ * A snapshot is the memory of the recorder buffer: a trace_header_t, then
+ * 'objects' trace_obj_t and 'capacity' trace_rec_t. Once the ring wraps the
+ * oldest record is at 'head' % 'capacity'.
+ *
+ * A stream is a sequence of frames, each a trace_frame_t followed by 'count'
+ * items: one trace_header_t, trace_obj_t or trace_rec_t. A capture can start
+ * anywhere, frames are found again by their magic.
+ *
+ * Both are decoded to a Perfetto trace by tools/trace_decode.
+ */
+
+#include <stdint.h>
+
+/*< Snapshot header magic, "TRC1" */
+#define TRACE_FORMAT_MAGIC (0x31435254UL)
+/*< Stream frame magic, "TRCF" */
+#define TRACE_FORMAT_FRAME_MAGIC (0x46435254UL)
+#define TRACE_FORMAT_VERSION (1)
+/*< Object name length, with the terminator when shorter */
+#define TRACE_FORMAT_NAME_LEN (14)
+/*< Object id of no object, e.g. a queue created before the recorder */
+#define TRACE_FORMAT_NO_ID (0)
+
+/*< Record type bit, for record filters */
+#define TRACE_REC_BIT(type) (1UL << (type))
+
+/* Recorder modes. Macros, not an enum, as they select code in #if */
+/*< Ring overwritten, read from a memory dump */
+#define TRACE_MODE_SNAPSHOT (0)
+/*< Ring drained to the UART, full drops newest */
+#define TRACE_MODE_STREAM (1)
+
+/**
+ * @brief Record types. Ids and arguments of each one.
+ *
+ */
+typedef enum {
+  TRACE_REC_NONE = 0,
+  TRACE_REC_TASK_IN,       /*< Task runs. Id: task */
+  TRACE_REC_TASK_OUT,      /*< Task stops running. Id: task */
+  TRACE_REC_TASK_READY,    /*< Task made ready. Id: task */
+  TRACE_REC_TICK,          /*< Tick interrupt. Arg: tick count low bits */
+  TRACE_REC_QUEUE_SEND,    /*< Id: queue. Arg: messages before the send */
+  TRACE_REC_QUEUE_RECEIVE, /*< Id: queue. Arg: messages before the receive */
+  TRACE_REC_ISR_ENTER,     /*< Id: exception number */
+  TRACE_REC_ISR_EXIT,      /*< Id: exception number */
+  TRACE_REC_AO_POST,       /*< Id: receiver AO. Arg: sender << 8 | byte 0 */
+  TRACE_REC_AO_BEGIN,      /*< Id: receiver AO. Arg: sender << 8 | byte 0 */
+  TRACE_REC_AO_END,        /*< Id: receiver AO */
+  TRACE_REC_MARK,          /*< User mark. Id: mark. Arg: value */
+  TRACE_REC_MAX,
+} trace_rec_type_t;
+
+typedef enum {
+  TRACE_OBJ_NONE = 0,
+  TRACE_OBJ_TASK,  /*< Ids given at creation */
+  TRACE_OBJ_QUEUE, /*< Ids given at creation, semaphores included */
+  TRACE_OBJ_AO,    /*< Ids are AO indexes, 0xFF is no AO */
+  TRACE_OBJ_ISR,   /*< Ids are exception numbers */
+  TRACE_OBJ_MARK,  /*< Ids are user marks */
+} trace_obj_kind_t;
+
+typedef enum {
+  TRACE_FRAME_HEADER = 1, /*< One trace_header_t */
+  TRACE_FRAME_OBJECTS,    /*< Object table, replaces the previous one */
+  TRACE_FRAME_RECORDS,    /*< Records, oldest first */
+} trace_frame_kind_t;
+
+typedef struct {
+  uint32_t cyc; /*< DWT cycle counter */
+  uint8_t type; /*< trace_rec_type_t */
+  uint8_t id;   /*< Object of the record */
+  uint16_t arg; /*< Argument, see trace_rec_type_t */
+} trace_rec_t;
+
+typedef struct {
+  uint8_t kind;                     /*< trace_obj_kind_t, NONE if free */
+  uint8_t id;                       /*< Id in the records */
+  char name[TRACE_FORMAT_NAME_LEN]; /*< Name, not always terminated */
+} trace_obj_t;
+
+typedef struct {
+  uint32_t magic;    /*< TRACE_FORMAT_MAGIC */
+  uint8_t version;   /*< TRACE_FORMAT_VERSION */
+  uint8_t mode;      /*< TRACE_MODE_* */
+  uint16_t objects;  /*< Object table entries */
+  uint32_t cpu_hz;   /*< Cycle counter frequency */
+  uint32_t capacity; /*< Ring records, a power of two */
+  uint32_t head;     /*< Records written since the start */
+  uint32_t dropped;  /*< Records lost while the stream was full */
+} trace_header_t;
+
+typedef struct {
+  uint32_t magic; /*< TRACE_FORMAT_FRAME_MAGIC */
+  uint8_t kind;   /*< trace_frame_kind_t */
+  uint8_t reserved;
+  uint16_t count; /*< Items after this frame header */
+} trace_frame_t;
+
+_Static_assert(sizeof(trace_rec_t) == 8, "Trace records must stay compact");
+_Static_assert(sizeof(trace_obj_t) == 16, "Trace objects are 16 bytes");
+_Static_assert(sizeof(trace_header_t) == 24, "Trace header is 24 bytes");
+_Static_assert(sizeof(trace_frame_t) == 8, "Trace frames are 8 bytes");
+
+#endif /* INC_TRACE_FORMAT_H_ */
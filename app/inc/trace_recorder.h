@@ -0,0 +1,95 @@
+/*
+ * trace_recorder.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_TRACE_RECORDER_H_
+#define INC_TRACE_RECORDER_H_
+
+#include "trace_format.h"
+#include <stdint.h>
+
+/*
+ * Kernel hooks are enabled by configUSE_TRACE_RECORDER in FreeRTOSConfig.h,
+ * every function does nothing without it.
+ */
+
+/*< TRACE_MODE_SNAPSHOT or TRACE_MODE_STREAM */
+#define TRACE_RECORDER_CONFIG_MODE (TRACE_MODE_SNAPSHOT)
+/*< Ring records, must be a power of two. 8 bytes each, in CCM RAM */
+#define TRACE_RECORDER_CONFIG_RECORDS (1024)
+/*< Object names kept, the oldest is replaced */
+#define TRACE_RECORDER_CONFIG_MAX_OBJECTS (32)
+/*< Record types stored. Ticks fill the ring with little to say */
+#define TRACE_RECORDER_CONFIG_FILTER (~TRACE_REC_BIT(TRACE_REC_TICK))
+/*< Time between two drains of the ring to the UART, stream mode */
+#define TRACE_RECORDER_CONFIG_STREAM_PERIOD_MS (10)
+
+/**
+ * @brief Start recording.
+ *
+ * @note Call it once the cycle counter runs. Objects created before are
+ * named anyway. In stream mode it creates the task that drains the ring to
+ * USART3, at the idle priority.
+ */
+void trace_recorder_init(void);
+/**
+ * @brief Empty the ring and record again.
+ */
+void trace_recorder_start(void);
+/**
+ * @brief Stop recording, e.g. when a fault is seen.
+ *
+ * @note In snapshot mode the ring keeps what led to it until the next
+ * 'trace_recorder_start'. Dump the 'trace_buffer' symbol from the debugger:
+ * dump binary memory trace.bin &trace_buffer (char *)&trace_buffer +
+ * sizeof(trace_buffer)
+ */
+void trace_recorder_stop(void);
+/**
+ * @brief Store a record stamped with the cycle counter.
+ *
+ * @note Any context, interrupts are masked for a few cycles.
+ *
+ * @param type Record type (trace_rec_type_t).
+ * @param id Object of the record.
+ * @param arg Argument of the record.
+ */
+void trace_recorder_put(uint8_t type, uint8_t id, uint16_t arg);
+/**
+ * @brief Name an object of the records.
+ *
+ * @param kind Object kind (trace_obj_kind_t).
+ * @param id Object id.
+ * @param name Name, truncated to TRACE_FORMAT_NAME_LEN.
+ */
+void trace_recorder_name(uint8_t kind, uint8_t id, const char *name);
+/**
+ * @brief Kernel hook, give an id to a task being created.
+ *
+ * @param name Task name.
+ * @return uint8_t Task id.
+ */
+uint8_t trace_recorder_on_task_create(const char *name);
+/**
+ * @brief Kernel hook, give an id to a queue being created.
+ *
+ * @note Queues are named "queue" until 'trace_recorder_name'.
+ *
+ * @return uint8_t Queue id.
+ */
+uint8_t trace_recorder_on_queue_create(void);
+/**
+ * @brief Record the entry of the running interrupt handler. First line of
+ * the handler.
+ */
+void trace_recorder_isr_enter(void);
+/**
+ * @brief Record the exit of the running interrupt handler. Last line of the
+ * handler.
+ */
+void trace_recorder_isr_exit(void);
+
+#endif /* INC_TRACE_RECORDER_H_ */
@@ -0,0 +1,71 @@
+/*
+ * ui_latency.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef INC_UI_LATENCY_H_
+#define INC_UI_LATENCY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*< Measure the button to led latency, functions do nothing without it */
+#define UI_LATENCY_CONFIG_ENABLE (1)
+/*< Presses kept for the percentiles, the oldest are replaced */
+#define UI_LATENCY_CONFIG_SAMPLES (32)
+/*< Drive the buttons with the scripted presses instead of the pins */
+#define UI_LATENCY_CONFIG_SCRIPT (0)
+
+/**
+ * @brief Stages of a press, in order. Each one is timed from the previous.
+ *
+ */
+typedef enum {
+  UI_LATENCY_EDGE = 0, /*< Input change first seen by the button scan */
+  UI_LATENCY_GESTURE,  /*< Gesture classified and sent to the UI */
+  UI_LATENCY_UI,       /*< UI handler started */
+  UI_LATENCY_LED,      /*< Led group handler started */
+  UI_LATENCY_GPIO,     /*< Led port written */
+  UI_LATENCY__N,
+} ui_latency_stage_t;
+
+/**
+ * @brief Time a stage of the press in flight.
+ *
+ * @note An edge starts a new press, so a gesture fired on release is timed
+ * from the release. A stage only counts after the previous one, the rest are
+ * ignored, e.g. the UI handler run by its own messages. The press is done at
+ * UI_LATENCY_GPIO, a press that changes no led is dropped at the next edge.
+ * The edge is seen on a scan, the time until then (up to one scan period)
+ * is not measured.
+ *
+ * @param stage Stage reached now.
+ */
+void ui_latency_mark(ui_latency_stage_t stage);
+/**
+ * @brief Get a percentile of a stage over the last presses.
+ *
+ * @param stage Stage, timed from the previous one. UI_LATENCY_EDGE is the
+ * whole press, from the edge to the led port.
+ * @param pct Percentile, 1 to 100.
+ * @return uint32_t DWT cycles, 0 without presses.
+ */
+uint32_t ui_latency_percentile(ui_latency_stage_t stage, uint8_t pct);
+/**
+ * @brief Log the percentiles of every stage, in microseconds.
+ */
+void ui_latency_report(void);
+/**
+ * @brief Next scripted button input, see UI_LATENCY_CONFIG_SCRIPT.
+ *
+ * @note The script is a fixed loop of pulse, short and long presses with a
+ * quiet time long enough to tear the UI down, so runs can be compared.
+ *
+ * @param period_ms Time since the previous call.
+ * @return true if the scripted button is pressed.
+ */
+bool ui_latency_script(uint32_t period_ms);
+
+#endif /* INC_UI_LATENCY_H_ */
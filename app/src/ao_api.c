@@ -5,30 +5,155 @@
  *      Author: guirespi
  */
 #include "ao_api.h"
+#include "ao_journal.h"
 #include "cmsis_os.h"
+#include "dwt.h"
+#include "linker_sections.h"
+#include "main.h"
+#include "stack_monitor.h"
+#include "trace_recorder.h"
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
+/*< AO index of no AO, e.g. a message without sender */
+#define AO_NONE_ (0xFFU)
+
+/*< Message as stored in an inbox, copied by value */
+typedef struct {
+  uint8_t sender;   /*< Sender AO index or AO_NONE_ */
+  uint8_t receiver; /*< Receiver AO index */
+  uint8_t size;     /*< Payload size */
+  uint8_t flags;    /*< AO_MSG_F_* */
+  uint8_t payload[AO_EV_PAYLOAD_SIZE]; /*< Payload, or pool block index */
+#if 1 == AO_EV_STAMP
+  uint32_t stamp; /*< Cycle counter when posted */
+#endif
+} ao_event_t;
+
+_Static_assert(sizeof(ao_event_t) == AO_EV_SIZE, "AO events must stay compact");
+
+typedef struct {
+  volatile uint32_t seq; /*< Ring position the slot is ready for */
+  ao_event_t ev;
+} ao_inbox_slot_t;
+
+/*< Bounded ring, many producers and the AO task as only consumer */
+typedef struct {
+  ao_inbox_slot_t slot[AO_INBOX_SIZE];
+  volatile uint32_t head;    /*< Next position to take, AO task only */
+  volatile uint32_t tail;    /*< Next position to reserve by producers */
+  volatile uint32_t waiting; /*< AO task sleeps on its notification */
+} ao_inbox_t;
+
 struct ao_t {
   bool used;
+  uint8_t ao_gen; /*< Times the slot was created, see AO_JOURNAL_ID */
+  ao_op_t ao_op;
   QueueHandle_t ao_queue;
   TaskHandle_t ao_task;
   ao_ev_handler_t ao_ev_f;
   ao_free_handler_t ao_free_f;
   uint8_t ao_data_size;
   uint8_t ao_data[AO_MAX_DATA_SIZE];
+  bool ao_mbox_pending;
+  ao_msg_t ao_mbox;
+  char ao_name[configMAX_TASK_NAME_LEN];
+  ao_inbox_t ao_inbox;
+  ao_policy_t ao_policy; /*< Overflow policy of the inbox */
+  TickType_t ao_wait;    /*< Wait for room with AO_POLICY_BLOCK */
+  ao_overflow_handler_t ao_overflow_f;
+  ao_overflow_stats_t ao_stats;
+  uint8_t ao_admit_max; /*< Waiting messages allowed per sender, 0 is off */
+  uint8_t ao_pending[AO_MAX_OBJECTS + 1]; /*< Waiting messages per sender */
+  ao_throttle_stats_t ao_throttle;
+  uint32_t ao_wait_budget; /*< Cycles from post to handler, 0 is off */
+  uint32_t ao_run_budget;  /*< Cycles in the handler, 0 is off */
+  ao_deadline_handler_t ao_deadline_f;
+  ao_deadline_stats_t ao_deadline;
+  ao_deadline_miss_t ao_miss; /*< Last miss, no receiver if none */
+  TaskHandle_t ao_runner;     /*< Task running its handler, if any */
 };
 
+/*< Token bucket of a (sender, receiver) pair */
+typedef struct {
+  uint16_t rate;    /*< Tokens per second, 0 if the entry is free */
+  uint8_t burst;    /*< Bucket size in tokens */
+  uint8_t sender;   /*< Sender AO index or AO_NONE_ */
+  uint8_t receiver; /*< Receiver AO index */
+  uint32_t tokens;  /*< Tokens, scaled by configTICK_RATE_HZ */
+  TickType_t last;  /*< Tick of the last refill */
+} ao_rate_t;
+
+/*< Replay mode, see ao_replay_begin */
+typedef struct {
+  TaskHandle_t task; /*< Replay task, NULL out of replay mode */
+  uint32_t now;      /*< Virtual cycle counter of the replay task */
+  ao_msg_t queue[AO_REPLAY_QUEUE_LEN]; /*< Posted by handlers, to run */
+  uint8_t head;                        /*< Oldest queued message */
+  uint8_t count;                       /*< Queued messages */
+  bool dropped; /*< Queue found full since the last dispatch */
+} ao_replay_t;
+
 typedef struct {
   struct ao_t ao_ins[AO_MAX_OBJECTS];
+  ao_rate_t rate[AO_MAX_RATE_LIMITS];
+  ao_msg_t pool[AO_MSG_POOL_SIZE]; /*< Messages too large for an event */
+  uint32_t pool_used;              /*< Bit 'n' set if pool block 'n' is taken */
+  ao_replay_t replay;
 } ao_sys_t;
 
-static ao_sys_t ao_sys;
+/*< AO control blocks and mailboxes are only touched by the CPU */
+static ao_sys_t ao_sys LINKER_SECTION_CCM;
 
 static void ao_task(void *pv_parameters);
+static void ao_task_lockfree(void *pv_parameters);
+static void ao_dispatch(const ao_event_t *ao_ev);
+static void ao_run(ao_msg_t *ao_msg, uint32_t stamp);
+static void ao_handle(ao_t ao, ao_msg_t *ao_msg);
+static uint32_t ao_now(void);
+static bool ao_replaying(void);
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+static bool ao_in_handler(void);
+static uint8_t ao_journal_id(ao_t ao);
+#endif
+static void ao_journal(ao_t receiver, ao_t sender, const uint8_t *ao_msg,
+                       uint8_t ao_msg_size, bool call);
+static int ao_replay_post(ao_t receiver, ao_t sender, const uint8_t *ao_msg,
+                          uint8_t ao_msg_size);
+static void ao_deadline_check(ao_t ao, ao_deadline_miss_t *ao_miss);
+static uint16_t ao_trace_arg(ao_t sender, const uint8_t *ao_msg);
+static bool ao_event_expand(const ao_event_t *ao_ev, ao_msg_t *ao_msg);
+static void ao_inbox_init(ao_inbox_t *inbox);
+static bool ao_inbox_push(ao_inbox_t *inbox, const ao_event_t *ao_ev);
+static bool ao_inbox_pop(ao_inbox_t *inbox, ao_event_t *ao_ev);
+static bool ao_has_inbox(ao_t ao);
+static uint8_t ao_index(ao_t ao);
+static ao_t ao_from_index(uint8_t index);
+static int ao_pool_take(void);
+static void ao_pool_give(uint8_t index);
+static uint8_t ao_sender_slot(uint8_t sender);
+static ao_rate_t *ao_rate_find(uint8_t receiver, uint8_t sender);
+static void ao_rate_refill(ao_rate_t *rate, TickType_t now);
+static int ao_admit(ao_t receiver, ao_t sender);
+static void ao_unadmit(uint8_t receiver, uint8_t sender);
+static void ao_count(uint32_t *counter);
+static bool ao_inbox_put(ao_t owner, const ao_event_t *ao_ev,
+                         TickType_t wait);
+static bool ao_queue_replace(QueueHandle_t hqueue, const ao_event_t *ao_ev,
+                             bool newest, ao_event_t *dropped);
+static void ao_discard(ao_t owner, const ao_event_t *ao_ev);
+static void ao_inbox_drain(ao_t ao);
+static int ao_post(ao_t owner, ao_event_t *ao_ev, ao_policy_t policy,
+                   TickType_t wait);
+static bool ao_mbox_take(ao_t ao, ao_msg_t *ao_msg);
+static int ao_mbox_post(ao_t receiver, ao_t sender, ao_t owner,
+                        uint8_t *ao_msg, uint8_t ao_msg_size,
+                        ao_policy_t policy, TickType_t wait);
 static int ao_create_object(struct ao_t *ao, uint8_t *ao_data,
                             uint8_t ao_data_size, ao_ev_handler_t ao_ev_f,
-                            ao_free_handler_t ao_free_f, ao_op_t ao_op);
+                            ao_free_handler_t ao_free_f, ao_op_t ao_op,
+                            const ao_config_t *ao_cfg);
 
 /**
  * @brief AO generic task.
@@ -38,12 +163,751 @@ static int ao_create_object(struct ao_t *ao, uint8_t *ao_data,
 static void ao_task(void *pv_parameters) {
   ao_t ao = (ao_t)pv_parameters;
   for (;;) {
-    ao_msg_t *ao_msg = NULL;
-    if (xQueueReceive(ao->ao_queue, &ao_msg, portMAX_DELAY)) {
-      // Executes receiver handler and sends message.
-      ao_msg->receiver->ao_ev_f(ao_msg);
+    ao_event_t ao_ev;
+    if (xQueueReceive(ao->ao_queue, &ao_ev, portMAX_DELAY))
+      ao_dispatch(&ao_ev);
+  }
+}
+
+/**
+ * @brief AO task of an AO with a lock-free inbox (AO_OP_LOCKFREE).
+ *
+ * @param pv_parameters AO instance.
+ */
+static void ao_task_lockfree(void *pv_parameters) {
+  ao_t ao = (ao_t)pv_parameters;
+  for (;;) {
+    ao_event_t ao_ev;
+    if (!ao_inbox_pop(&ao->ao_inbox, &ao_ev)) {
+      // Announce the sleep, then look again so a post in between is not lost.
+      ao->ao_inbox.waiting = 1;
+      __DMB();
+      if (!ao_inbox_pop(&ao->ao_inbox, &ao_ev)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        continue;
+      }
+      ao->ao_inbox.waiting = 0;
+    }
+    ao_dispatch(&ao_ev);
+  }
+}
+
+/**
+ * @brief Call the receiver handler of an event taken from an inbox.
+ *
+ * @param ao_ev AO event.
+ */
+static void ao_dispatch(const ao_event_t *ao_ev) {
+  ao_msg_t ao_msg;
+  if (!ao_event_expand(ao_ev, &ao_msg))
+    return;
+
+#if 1 == AO_EV_STAMP
+  uint32_t stamp = ao_ev->stamp;
+#else
+  uint32_t stamp = ao_now();
+#endif
+  // Executes receiver handler and sends message.
+  ao_run(&ao_msg, stamp);
+}
+
+/**
+ * @brief Run the receiver handler of a message checking its deadlines.
+ *
+ * @param ao_msg AO message.
+ * @param stamp Cycle counter when the message was posted.
+ */
+static void ao_run(ao_msg_t *ao_msg, uint32_t stamp) {
+  ao_t receiver = ao_msg->receiver;
+  uint8_t index = ao_index(receiver);
+  trace_recorder_put(TRACE_REC_AO_BEGIN, index,
+                     ao_trace_arg(ao_msg->sender, ao_msg->ao_msg));
+  if (receiver->ao_wait_budget == 0 && receiver->ao_run_budget == 0) {
+    ao_handle(receiver, ao_msg);
+    trace_recorder_put(TRACE_REC_AO_END, index, 0);
+    return;
+  }
+
+  // Kept before the handler, it can change the message.
+  ao_deadline_miss_t ao_miss = {.ao_msg = *ao_msg};
+  uint32_t now = ao_now();
+  uint32_t start = cycle_counter_get();
+  ao_handle(receiver, ao_msg);
+  ao_miss.run = cycle_counter_get() - start;
+  ao_miss.wait = now - stamp;
+  trace_recorder_put(TRACE_REC_AO_END, index, 0);
+
+  if (receiver->used) // Unless its handler deinit it.
+    ao_deadline_check(receiver, &ao_miss);
+}
+
+/**
+ * @brief Call the handler of an AO, known as running in the caller task.
+ *
+ * @param ao Receiver AO.
+ * @param ao_msg AO message.
+ */
+static void ao_handle(ao_t ao, ao_msg_t *ao_msg) {
+  TaskHandle_t runner = ao->ao_runner; // Outer run of the same AO, if any.
+  ao->ao_runner = xTaskGetCurrentTaskHandle();
+  ao->ao_ev_f(ao_msg);
+  if (ao->used) // Unless its handler deinit it.
+    ao->ao_runner = runner;
+}
+
+/**
+ * @brief AO clock, the cycle counter or the virtual one of the replay task.
+ *
+ * @return uint32_t Cycles.
+ */
+static uint32_t ao_now(void) {
+  if (ao_replaying())
+    return ao_sys.replay.now;
+  return cycle_counter_get();
+}
+
+/**
+ * @brief Whether the caller is the replay task, see ao_replay_begin.
+ *
+ * @return true if in replay mode and called from its task.
+ */
+static bool ao_replaying(void) {
+  return ao_sys.replay.task != NULL &&
+         ao_sys.replay.task == xTaskGetCurrentTaskHandle();
+}
+
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+/**
+ * @brief Whether the caller runs inside an AO handler.
+ *
+ * @return true if a handler runs in the caller task.
+ */
+static bool ao_in_handler(void) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  for (uint8_t i = 0; i < AO_MAX_OBJECTS; i++) {
+    ao_t ao = &ao_sys.ao_ins[i];
+    if (ao->used && ao->ao_runner != NULL && ao->ao_runner == task)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Journaled id of an AO, its slot and generation.
+ *
+ * @param ao AO instance or NULL.
+ * @return uint8_t AO_JOURNAL_ID, AO_JOURNAL_NO_AO for NULL.
+ */
+static uint8_t ao_journal_id(ao_t ao) {
+  if (ao == NULL)
+    return AO_JOURNAL_NO_AO;
+  return AO_JOURNAL_ID(ao_index(ao), ao->ao_gen);
+}
+#endif
+
+/**
+ * @brief Journal a message accepted for a receiver.
+ *
+ * @note Messages posted outside handlers are the roots a replay feeds, the
+ * rest are posted again by the handlers.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO or NULL.
+ * @param ao_msg Message payload.
+ * @param ao_msg_size Message size.
+ * @param call Run by 'ao_call'.
+ */
+static void ao_journal(ao_t receiver, ao_t sender, const uint8_t *ao_msg,
+                       uint8_t ao_msg_size, bool call) {
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+  uint8_t flags = call ? AO_JOURNAL_F_CALL : 0;
+  if (!ao_in_handler())
+    flags |= AO_JOURNAL_F_ROOT;
+  ao_journal_put(ao_journal_id(sender), ao_journal_id(receiver), ao_msg,
+                 ao_msg_size, flags);
+#endif
+}
+
+/**
+ * @brief Queue a message posted in replay mode, see ao_replay_begin.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO or NULL.
+ * @param ao_msg Message payload.
+ * @param ao_msg_size Message size.
+ * @return int
+ * 				- AO_OK if no error.
+ * 				- AO_E_OS if not posted from the replay task.
+ * 				- AO_E_FULL if the replay queue is full.
+ */
+static int ao_replay_post(ao_t receiver, ao_t sender, const uint8_t *ao_msg,
+                          uint8_t ao_msg_size) {
+  ao_replay_t *replay = &ao_sys.replay;
+  if (!ao_replaying())
+    return AO_E_OS; // Inputs must be quiet during a replay.
+  trace_recorder_put(TRACE_REC_AO_POST, ao_index(receiver),
+                     ao_trace_arg(sender, ao_msg));
+  ao_journal(receiver, sender, ao_msg, ao_msg_size, false);
+
+  // Only the replay task touches the queue, no lock.
+  ao_msg_t *slot = NULL;
+  if (receiver->ao_op & AO_OP_COALESCE) {
+    // Last value wins, as in its mailbox.
+    for (uint8_t i = 0; slot == NULL && i < replay->count; i++) {
+      ao_msg_t *queued =
+          &replay->queue[(replay->head + i) % AO_REPLAY_QUEUE_LEN];
+      if (queued->receiver == receiver)
+        slot = queued;
+    }
+  }
+  if (slot == NULL) {
+    if (replay->count == AO_REPLAY_QUEUE_LEN) {
+      replay->dropped = true;
+      return AO_E_FULL;
+    }
+    slot = &replay->queue[(replay->head + replay->count) % AO_REPLAY_QUEUE_LEN];
+    replay->count++;
+  }
+
+  memset(slot, 0, sizeof(*slot));
+  slot->sender = sender;
+  slot->receiver = receiver;
+  slot->ao_msg_size = ao_msg_size;
+  slot->ao_msg_flags = AO_MSG_F_NO_FREE;
+  memcpy(slot->ao_msg, ao_msg, ao_msg_size);
+  return AO_OK;
+}
+
+/**
+ * @brief Account a handled message against the deadlines of its receiver.
+ *
+ * @param ao Receiver AO.
+ * @param ao_miss Handled message and its times.
+ */
+static void ao_deadline_check(ao_t ao, ao_deadline_miss_t *ao_miss) {
+  bool late = ao->ao_wait_budget != 0 && ao_miss->wait > ao->ao_wait_budget;
+  bool overrun = ao->ao_run_budget != 0 && ao_miss->run > ao->ao_run_budget;
+  ao_deadline_handler_t ao_deadline_f;
+
+  ao_miss->tick = xTaskGetTickCount();
+  taskENTER_CRITICAL();
+  {
+    ao_deadline_stats_t *stats = &ao->ao_deadline;
+    if (ao_miss->wait > stats->wait_max)
+      stats->wait_max = ao_miss->wait;
+    if (ao_miss->run > stats->run_max)
+      stats->run_max = ao_miss->run;
+    if (late)
+      stats->late++;
+    if (overrun)
+      stats->overruns++;
+    if (late || overrun)
+      ao->ao_miss = *ao_miss;
+    ao_deadline_f = ao->ao_deadline_f;
+  }
+  taskEXIT_CRITICAL();
+
+  if ((late || overrun) && ao_deadline_f != NULL)
+    ao_deadline_f(ao, ao_miss);
+}
+
+/**
+ * @brief Trace argument of an AO message: its sender and first byte, the
+ * signal for most AOs.
+ *
+ * @param sender Sender AO or NULL.
+ * @param ao_msg Message payload.
+ * @return uint16_t Argument of TRACE_REC_AO_POST and TRACE_REC_AO_BEGIN.
+ */
+static uint16_t ao_trace_arg(ao_t sender, const uint8_t *ao_msg) {
+  return (uint16_t)((ao_index(sender) << 8) | ao_msg[0]);
+}
+
+/**
+ * @brief Expand an event taken out of an inbox into a message.
+ *
+ * @note The message is flagged AO_MSG_F_NO_FREE. Whatever the event held is
+ * reclaimed: the pool block is released and the mailbox of a doorbell taken.
+ *
+ * @param ao_ev AO event.
+ * @param ao_msg Where the message is built.
+ * @return true if there is a message, false for a doorbell of an empty
+ * mailbox.
+ */
+static bool ao_event_expand(const ao_event_t *ao_ev, ao_msg_t *ao_msg) {
+  ao_t receiver = ao_from_index(ao_ev->receiver);
+
+  memset(ao_msg, 0, sizeof(*ao_msg));
+  if (ao_ev->flags & AO_MSG_F_MBOX) {
+    // Doorbell of a coalescing AO. Its latest value, if any.
+    if (!ao_mbox_take(receiver, ao_msg))
+      return false;
+  } else if (ao_ev->flags & AO_MSG_F_POOL) {
+    *ao_msg = ao_sys.pool[ao_ev->payload[0]];
+    ao_pool_give(ao_ev->payload[0]);
+    ao_unadmit(ao_ev->receiver, ao_ev->sender);
+  } else {
+    ao_msg->sender = ao_from_index(ao_ev->sender);
+    ao_msg->receiver = receiver;
+    ao_msg->ao_msg_size = ao_ev->size;
+    memcpy(ao_msg->ao_msg, ao_ev->payload, AO_EV_PAYLOAD_SIZE);
+    ao_unadmit(ao_ev->receiver, ao_ev->sender);
+  }
+  ao_msg->ao_msg_flags = AO_MSG_F_NO_FREE;
+  return true;
+}
+
+/**
+ * @brief Empty a lock-free inbox.
+ *
+ * @param inbox Inbox.
+ */
+static void ao_inbox_init(ao_inbox_t *inbox) {
+  for (uint32_t i = 0; i < AO_INBOX_SIZE; i++) {
+    inbox->slot[i].seq = i;
+  }
+  inbox->head = 0;
+  inbox->tail = 0;
+  inbox->waiting = 0;
+}
+
+/**
+ * @brief Add a message to a lock-free inbox.
+ *
+ * @note Producers reserve a position with LDREX/STREX on the tail, so tasks
+ * preempting each other can post without a critical section. The slot is
+ * published afterwards through its sequence number.
+ *
+ * @param inbox Inbox.
+ * @param ao_ev AO event, copied into the slot.
+ * @return true if added, false if the inbox is full.
+ */
+static bool ao_inbox_push(ao_inbox_t *inbox, const ao_event_t *ao_ev) {
+  uint32_t pos;
+  ao_inbox_slot_t *slot;
+  for (;;) {
+    pos = __LDREXW(&inbox->tail);
+    slot = &inbox->slot[pos & (AO_INBOX_SIZE - 1U)];
+    int32_t diff = (int32_t)(slot->seq - pos);
+    if (diff < 0) {
+      __CLREX();
+      return false; // Not taken by the AO task yet, the inbox is full.
+    }
+    if (diff > 0) {
+      __CLREX();
+      continue; // Another producer took this position, retry.
+    }
+    if (__STREXW(pos + 1U, &inbox->tail) == 0U)
+      break;
+  }
+  slot->ev = *ao_ev;
+  __DMB(); // Event stored before the slot is published.
+  slot->seq = pos + 1U;
+  return true;
+}
+
+/**
+ * @brief Take the oldest message of a lock-free inbox. AO task only.
+ *
+ * @param inbox Inbox.
+ * @param ao_ev Where the event is copied.
+ * @return true if an event was published.
+ */
+static bool ao_inbox_pop(ao_inbox_t *inbox, ao_event_t *ao_ev) {
+  uint32_t pos = inbox->head;
+  ao_inbox_slot_t *slot = &inbox->slot[pos & (AO_INBOX_SIZE - 1U)];
+  if (slot->seq != pos + 1U)
+    return false;
+  __DMB();
+  *ao_ev = slot->ev;
+  __DMB(); // Event read before the slot is handed back to producers.
+  slot->seq = pos + AO_INBOX_SIZE;
+  inbox->head = pos + 1U;
+  return true;
+}
+
+/**
+ * @brief Check if an AO handles messages in its own task.
+ *
+ * @param ao AO instance.
+ * @return true if it has a queue or a lock-free inbox.
+ */
+static bool ao_has_inbox(ao_t ao) {
+  return ao->ao_queue != NULL || (ao->ao_op & AO_OP_LOCKFREE);
+}
+
+/**
+ * @brief Index of an AO in the system table.
+ *
+ * @param ao AO instance or NULL.
+ * @return uint8_t Index, AO_NONE_ for NULL.
+ */
+static uint8_t ao_index(ao_t ao) {
+  return ao == NULL ? AO_NONE_ : (uint8_t)(ao - ao_sys.ao_ins);
+}
+
+/**
+ * @brief AO instance of an index of the system table.
+ *
+ * @param index Index or AO_NONE_.
+ * @return ao_t AO instance, NULL for AO_NONE_.
+ */
+static ao_t ao_from_index(uint8_t index) {
+  return index == AO_NONE_ ? NULL : &ao_sys.ao_ins[index];
+}
+
+/**
+ * @brief Take a free block of the AO message pool.
+ *
+ * @return int Block index, -1 if the pool is exhausted.
+ */
+static int ao_pool_take(void) {
+  int index = -1;
+  taskENTER_CRITICAL();
+  {
+    for (uint8_t i = 0; i < AO_MSG_POOL_SIZE; i++) {
+      if ((ao_sys.pool_used & (1UL << i)) == 0) {
+        ao_sys.pool_used |= (1UL << i);
+        index = i;
+        break;
+      }
     }
   }
+  taskEXIT_CRITICAL();
+  return index;
+}
+
+/**
+ * @brief Give a block back to the AO message pool.
+ *
+ * @param index Block index.
+ */
+static void ao_pool_give(uint8_t index) {
+  taskENTER_CRITICAL();
+  ao_sys.pool_used &= ~(1UL << index);
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Slot of a sender in the waiting message counters of a receiver.
+ *
+ * @param sender Sender AO index or AO_NONE_.
+ * @return uint8_t Slot, the last one for messages without sender.
+ */
+static uint8_t ao_sender_slot(uint8_t sender) {
+  return sender == AO_NONE_ ? AO_MAX_OBJECTS : sender;
+}
+
+/**
+ * @brief Find the token bucket of a (sender, receiver) pair.
+ *
+ * @param receiver Receiver AO index.
+ * @param sender Sender AO index or AO_NONE_.
+ * @return ao_rate_t* Bucket, NULL if the pair is not limited.
+ */
+static ao_rate_t *ao_rate_find(uint8_t receiver, uint8_t sender) {
+  for (uint8_t i = 0; i < AO_MAX_RATE_LIMITS; i++) {
+    ao_rate_t *rate = &ao_sys.rate[i];
+    if (rate->rate != 0 && rate->receiver == receiver &&
+        rate->sender == sender)
+      return rate;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Add the tokens earned since the last refill.
+ *
+ * @param rate Token bucket.
+ * @param now Current tick.
+ */
+static void ao_rate_refill(ao_rate_t *rate, TickType_t now) {
+  uint32_t full = (uint32_t)rate->burst * configTICK_RATE_HZ;
+  uint32_t elapsed = (uint32_t)(now - rate->last);
+  rate->last = now;
+  // Longer waits fill the bucket anyway, bound the product.
+  if (elapsed > full / rate->rate + 1U)
+    elapsed = full / rate->rate + 1U;
+  rate->tokens += rate->rate * elapsed;
+  if (rate->tokens > full)
+    rate->tokens = full;
+}
+
+/**
+ * @brief Check the rate limit and admission control of a send.
+ *
+ * @note An admitted message takes a token and counts as waiting for the
+ * receiver until it is expanded out of the inbox.
+ *
+ * @param receiver Receiver AO.
+ * @param sender Sender AO or NULL.
+ * @return int
+ * 				- AO_OK if admitted.
+ * 				- AO_E_THROTTLED if not.
+ */
+static int ao_admit(ao_t receiver, ao_t sender) {
+  uint8_t r = ao_index(receiver), s = ao_index(sender);
+  uint8_t *pending = &receiver->ao_pending[ao_sender_slot(s)];
+  // A coalescing mailbox can not fill, its messages are not counted.
+  bool track = !(receiver->ao_op & AO_OP_COALESCE);
+  TickType_t now = xTaskGetTickCount();
+  int err = AO_OK;
+
+  taskENTER_CRITICAL();
+  {
+    ao_rate_t *rate = ao_rate_find(r, s);
+    if (rate != NULL)
+      ao_rate_refill(rate, now);
+
+    if (rate != NULL && rate->tokens < configTICK_RATE_HZ) {
+      receiver->ao_throttle.rate_limited++;
+      err = AO_E_THROTTLED;
+    } else if (track && receiver->ao_admit_max != 0 &&
+               *pending >= receiver->ao_admit_max) {
+      receiver->ao_throttle.not_admitted++;
+      err = AO_E_THROTTLED;
+    } else {
+      if (rate != NULL)
+        rate->tokens -= configTICK_RATE_HZ;
+      if (track)
+        (*pending)++;
+    }
+  }
+  taskEXIT_CRITICAL();
+  return err;
+}
+
+/**
+ * @brief A message admitted by ao_admit no longer waits for its receiver.
+ *
+ * @param receiver Receiver AO index.
+ * @param sender Sender AO index or AO_NONE_.
+ */
+static void ao_unadmit(uint8_t receiver, uint8_t sender) {
+  uint8_t *pending =
+      &ao_sys.ao_ins[receiver].ao_pending[ao_sender_slot(sender)];
+  taskENTER_CRITICAL();
+  if (*pending > 0)
+    (*pending)--;
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Increment an overflow counter.
+ *
+ * @param counter Counter.
+ */
+static void ao_count(uint32_t *counter) {
+  taskENTER_CRITICAL();
+  (*counter)++;
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Put an event in the inbox of an AO.
+ *
+ * @note A lock-free inbox only notifies its task when it sleeps. Only its
+ * task takes from it, so waiting for room polls it once per tick.
+ *
+ * @param owner AO whose task handles the event.
+ * @param ao_ev AO event, copied into the inbox.
+ * @param wait Ticks to wait for room.
+ * @return true if the event is in the inbox.
+ */
+static bool ao_inbox_put(ao_t owner, const ao_event_t *ao_ev,
+                         TickType_t wait) {
+  if (owner->ao_op & AO_OP_LOCKFREE) {
+    while (!ao_inbox_push(&owner->ao_inbox, ao_ev)) {
+      if (wait-- == 0)
+        return false;
+      vTaskDelay(1);
+    }
+    __DMB();
+    if (owner->ao_inbox.waiting) {
+      owner->ao_inbox.waiting = 0;
+      xTaskNotifyGive(owner->ao_task);
+    }
+    return true;
+  }
+  return xQueueSend(owner->ao_queue, ao_ev, wait) == pdPASS;
+}
+
+/**
+ * @brief Put an event in a full queue discarding a queued one.
+ *
+ * @note The scheduler is suspended, so no task takes nor posts meanwhile.
+ * The queue is checked again under it, an event is only discarded if it is
+ * still full.
+ *
+ * @param hqueue Queue.
+ * @param ao_ev AO event to put.
+ * @param newest Discard the newest queued event instead of the oldest.
+ * @param dropped Where the discarded event is copied.
+ * @return true if an event was discarded, false if the queue had room.
+ */
+static bool ao_queue_replace(QueueHandle_t hqueue, const ao_event_t *ao_ev,
+                             bool newest, ao_event_t *dropped) {
+  bool replaced = false;
+
+  vTaskSuspendAll();
+  {
+    // Found full before the lock, the AO task may have taken one since.
+    if (uxQueueSpacesAvailable(hqueue) == 0) {
+      if (newest) {
+        // A queue only gives its oldest. Rotate the others behind the newest
+        // so it comes out first, the order is kept.
+        UBaseType_t count = uxQueueMessagesWaiting(hqueue);
+        for (UBaseType_t i = 1; i < count; i++) {
+          ao_event_t queued;
+          xQueueReceive(hqueue, &queued, 0);
+          xQueueSend(hqueue, &queued, 0);
+        }
+      }
+      replaced = xQueueReceive(hqueue, dropped, 0) == pdPASS;
+    }
+    xQueueSend(hqueue, ao_ev, 0);
+  }
+  xTaskResumeAll();
+  return replaced;
+}
+
+/**
+ * @brief Reclaim an event discarded by an overflow policy.
+ *
+ * @param owner AO whose inbox overflowed.
+ * @param ao_ev Discarded event.
+ */
+static void ao_discard(ao_t owner, const ao_event_t *ao_ev) {
+  ao_msg_t ao_msg;
+  ao_count(&owner->ao_stats.dropped);
+  if (ao_event_expand(ao_ev, &ao_msg) && owner->ao_overflow_f != NULL)
+    owner->ao_overflow_f(owner, &ao_msg);
+}
+
+/**
+ * @brief Reclaim every event left in the inbox of an AO.
+ *
+ * @param ao AO instance.
+ */
+static void ao_inbox_drain(ao_t ao) {
+  ao_event_t ao_ev;
+  ao_msg_t ao_msg;
+  if (ao->ao_queue != NULL) {
+    while (xQueueReceive(ao->ao_queue, &ao_ev, 0) == pdPASS)
+      ao_event_expand(&ao_ev, &ao_msg);
+  } else if (ao->ao_op & AO_OP_LOCKFREE) {
+    while (ao_inbox_pop(&ao->ao_inbox, &ao_ev))
+      ao_event_expand(&ao_ev, &ao_msg);
+  }
+}
+
+/**
+ * @brief Post an event in the inbox of an AO applying an overflow policy.
+ *
+ * @note The event is always reclaimed, also when discarded.
+ *
+ * @param owner AO whose task handles the event.
+ * @param ao_ev AO event, stamped with the post time.
+ * @param policy Overflow policy, AO_POLICY_DEFAULT for the owner one.
+ * @param wait Ticks to wait for room with AO_POLICY_BLOCK.
+ * @return int
+ * 				- AO_OK if no error.
+ * 				- AO_E_FULL if the event was discarded.
+ */
+static int ao_post(ao_t owner, ao_event_t *ao_ev, ao_policy_t policy,
+                   TickType_t wait) {
+  if (policy == AO_POLICY_DEFAULT) {
+    policy = owner->ao_policy;
+    wait = owner->ao_wait;
+  }
+#if 1 == AO_EV_STAMP
+  ao_ev->stamp = ao_now();
+#endif
+
+  if (ao_inbox_put(owner, ao_ev, 0))
+    return AO_OK;
+  ao_count(&owner->ao_stats.overflows);
+
+  if (policy == AO_POLICY_BLOCK) {
+    ao_count(&owner->ao_stats.blocked);
+    if (ao_inbox_put(owner, ao_ev, wait))
+      return AO_OK;
+  } else if (owner->ao_queue != NULL && (policy == AO_POLICY_DROP_OLDEST ||
+                                         policy == AO_POLICY_OVERWRITE)) {
+    ao_event_t dropped;
+    if (ao_queue_replace(owner->ao_queue, ao_ev,
+                         policy == AO_POLICY_OVERWRITE, &dropped))
+      ao_discard(owner, &dropped);
+    return AO_OK;
+  }
+
+  ao_discard(owner, ao_ev);
+  return AO_E_FULL;
+}
+
+/**
+ * @brief Take the pending message of a coalescing AO mailbox.
+ *
+ * @param ao Coalescing AO.
+ * @param ao_msg Where the pending message is copied.
+ * @return true if a message was pending.
+ */
+static bool ao_mbox_take(ao_t ao, ao_msg_t *ao_msg) {
+  bool pending;
+  taskENTER_CRITICAL();
+  {
+    pending = ao->ao_mbox_pending;
+    if (pending) {
+      *ao_msg = ao->ao_mbox;
+      ao->ao_mbox_pending = false;
+    }
+  }
+  taskEXIT_CRITICAL();
+  return pending;
+}
+
+/**
+ * @brief Post a message to a coalescing AO mailbox.
+ *
+ * @note The message overwrites any pending one. Only the first message of a
+ * burst rings the doorbell in the handling queue, the rest are collapsed in
+ * the mailbox slot without allocation nor queue operations.
+ *
+ * @param receiver Coalescing receiver AO.
+ * @param sender Sender AO.
+ * @param owner AO whose task handles the receiver messages.
+ * @param ao_msg AO message pointer.
+ * @param ao_msg_size AO message size.
+ * @param policy Overflow policy for the doorbell.
+ * @param wait Ticks to wait for room with AO_POLICY_BLOCK.
+ * @return int
+ * 				- AO_OK if no error.
+ */
+static int ao_mbox_post(ao_t receiver, ao_t sender, ao_t owner,
+                        uint8_t *ao_msg, uint8_t ao_msg_size,
+                        ao_policy_t policy, TickType_t wait) {
+  bool ring;
+  taskENTER_CRITICAL();
+  {
+    receiver->ao_mbox.sender = sender;
+    receiver->ao_mbox.receiver = receiver;
+    receiver->ao_mbox.ao_msg_size = ao_msg_size;
+    receiver->ao_mbox.ao_msg_flags = AO_MSG_F_NO_FREE | AO_MSG_F_MBOX;
+    memset(receiver->ao_mbox.ao_msg, 0, sizeof(receiver->ao_mbox.ao_msg));
+    memcpy(receiver->ao_mbox.ao_msg, ao_msg, ao_msg_size);
+    ring = !receiver->ao_mbox_pending;
+    receiver->ao_mbox_pending = true;
+  }
+  taskEXIT_CRITICAL();
+
+  if (!ring)
+    return AO_OK; // Coalesced with the message already pending.
+
+  // A discarded doorbell takes the mailbox with it.
+  ao_event_t doorbell = {.sender = ao_index(sender),
+                         .receiver = ao_index(receiver),
+                         .flags = AO_MSG_F_MBOX};
+  return ao_post(owner, &doorbell, policy, wait);
 }
 
 /**
@@ -55,36 +919,87 @@ static void ao_task(void *pv_parameters) {
  * @param ao_ev_f AO event handler.
  * @param ao_free_f AO free message handler.
  * @param ao_op AO operation flags.
+ * @param ao_cfg AO resources, NULL for the defaults.
  * @return int
  * 				- AO_OK if no error.
  */
 static int ao_create_object(struct ao_t *ao, uint8_t *ao_data,
                             uint8_t ao_data_size, ao_ev_handler_t ao_ev_f,
-                            ao_free_handler_t ao_free_f, ao_op_t ao_op) {
+                            ao_free_handler_t ao_free_f, ao_op_t ao_op,
+                            const ao_config_t *ao_cfg) {
+  static const ao_config_t ao_cfg_default = {0};
+  if (ao_cfg == NULL)
+    ao_cfg = &ao_cfg_default;
+  uint8_t queue_len = ao_cfg->queue_len ? ao_cfg->queue_len : AO_MAX_QUEUE_MSG;
+  uint16_t stack_size =
+      ao_cfg->stack_size ? ao_cfg->stack_size : AO_TASK_STACK_SIZE;
+  UBaseType_t priority = ao_cfg->priority
+                             ? ao_cfg->priority
+                             : tskIDLE_PRIORITY + AO_TASK_PRIORITY;
+
   if (ao_data_size > AO_MAX_DATA_SIZE)
     return AO_E_SIZE;
   if (ao_data_size > 0 && ao_data == NULL)
     return AO_E_ARG;
+  if ((ao_op & AO_OP_LOCKFREE) && (ao_op & AO_OP_NO_TASK))
+    return AO_E_ARG; // The lock-free inbox is drained by the AO task.
+  if ((ao_op & AO_OP_SYNC) && !(ao_op & AO_OP_NO_TASK))
+    return AO_E_ARG; // An AO task could run the same handler at once.
 
   ao->ao_data_size = ao_data_size;
   memcpy(ao->ao_data, ao_data, ao->ao_data_size);
 
+  // A new AO in this slot, its messages are journaled apart.
+  ao->ao_gen++;
   ao->ao_ev_f = ao_ev_f;
   ao->ao_free_f = ao_free_f;
+  ao->ao_op = ao_op;
+  ao->ao_mbox_pending = false;
+  ao->ao_policy = AO_POLICY_DROP_NEWEST;
+  ao->ao_wait = 0;
+  ao->ao_overflow_f = NULL;
+  memset(&ao->ao_stats, 0, sizeof(ao->ao_stats));
+  ao->ao_admit_max = 0;
+  memset(ao->ao_pending, 0, sizeof(ao->ao_pending));
+  memset(&ao->ao_throttle, 0, sizeof(ao->ao_throttle));
+  ao->ao_wait_budget = 0;
+  ao->ao_run_budget = 0;
+  ao->ao_deadline_f = NULL;
+  memset(&ao->ao_deadline, 0, sizeof(ao->ao_deadline));
+  memset(&ao->ao_miss, 0, sizeof(ao->ao_miss));
+  ao->ao_runner = NULL;
 
   // Create queue if necessary
-  if ((ao_op & AO_OP_NO_QUEUE) != AO_OP_NO_QUEUE) {
-    ao->ao_queue = xQueueCreate(AO_MAX_QUEUE_MSG, sizeof(void *));
+  if (ao_op & AO_OP_LOCKFREE) {
+    ao->ao_queue = NULL;
+    ao_inbox_init(&ao->ao_inbox);
+  } else if ((ao_op & AO_OP_NO_QUEUE) != AO_OP_NO_QUEUE) {
+    ao->ao_queue = xQueueCreate(queue_len, sizeof(ao_event_t));
     if (ao->ao_queue == NULL)
       return AO_E_OS;
   } else {
     ao->ao_queue = NULL;
   }
 
+  // Unnamed AOs are named after their slot so the stack monitor and the
+  // trace follow them across re-creations
+  if (ao_cfg->name != NULL)
+    snprintf(ao->ao_name, sizeof(ao->ao_name), "%s", ao_cfg->name);
+  else
+    snprintf(ao->ao_name, sizeof(ao->ao_name), "ao_task_%u",
+             (unsigned)(ao - ao_sys.ao_ins));
+  trace_recorder_name(TRACE_OBJ_AO, ao_index(ao), ao->ao_name);
+  if (ao->ao_queue != NULL)
+    trace_recorder_name(TRACE_OBJ_QUEUE,
+                        (uint8_t)uxQueueGetQueueNumber(ao->ao_queue),
+                        ao->ao_name);
+
   // Create task if necessary. If fails, destroy previous queue
   if ((ao_op & AO_OP_NO_TASK) != AO_OP_NO_TASK) {
-    BaseType_t rt = xTaskCreate(ao_task, "ao_task", 128, (void *const)ao,
-                                tskIDLE_PRIORITY + 1, &ao->ao_task);
+    TaskFunction_t task_f =
+        (ao_op & AO_OP_LOCKFREE) ? ao_task_lockfree : ao_task;
+    BaseType_t rt = xTaskCreate(task_f, ao->ao_name, stack_size,
+                                (void *const)ao, priority, &ao->ao_task);
     if (rt == pdFAIL) {
       if (ao->ao_queue != NULL) {
         vQueueDelete(ao->ao_queue);
@@ -92,6 +1007,7 @@ static int ao_create_object(struct ao_t *ao, uint8_t *ao_data,
       }
       return AO_E_OS;
     }
+    stack_monitor_register(ao->ao_task, ao->ao_name, stack_size);
   } else
     ao->ao_task = NULL;
 
@@ -101,12 +1017,13 @@ static int ao_create_object(struct ao_t *ao, uint8_t *ao_data,
 }
 
 ao_t ao_init(uint8_t *ao_data, uint8_t ao_data_size, ao_ev_handler_t ao_ev_f,
-             ao_free_handler_t ao_free_f, ao_op_t ao_op) {
+             ao_free_handler_t ao_free_f, ao_op_t ao_op,
+             const ao_config_t *ao_cfg) {
   for (uint8_t i = 0; i < AO_MAX_OBJECTS; i++) {
     if (false == ao_sys.ao_ins[i].used) {
       ao_t ao = &ao_sys.ao_ins[i];
       int rt = ao_create_object(ao, ao_data, ao_data_size, ao_ev_f, ao_free_f,
-                                ao_op);
+                                ao_op, ao_cfg);
       if (rt != AO_OK)
         return NULL;
       return ao;
@@ -117,9 +1034,22 @@ ao_t ao_init(uint8_t *ao_data, uint8_t ao_data_size, ao_ev_handler_t ao_ev_f,
 
 void ao_deinit(ao_t ao) {
 
+  // Reclaim the messages still waiting, pooled ones hold a block.
+  ao_inbox_drain(ao);
+
+  // Its rate limits go with it, as receiver or sender.
+  taskENTER_CRITICAL();
+  for (uint8_t i = 0; i < AO_MAX_RATE_LIMITS; i++) {
+    ao_rate_t *rate = &ao_sys.rate[i];
+    if (rate->receiver == ao_index(ao) || rate->sender == ao_index(ao))
+      rate->rate = 0;
+  }
+  taskEXIT_CRITICAL();
+
   ao->used = false;
   memset(ao->ao_data, 0, ao->ao_data_size);
   ao->ao_data_size = 0;
+  ao->ao_mbox_pending = false; // Any doorbell left in a queue becomes stale.
 
   if (ao->ao_queue) {
     vQueueDelete(ao->ao_queue);
@@ -128,6 +1058,7 @@ void ao_deinit(ao_t ao) {
   if (ao->ao_task) {
     TaskHandle_t temp = ao->ao_task;
     ao->ao_task = NULL;
+    stack_monitor_unregister(temp);
     vTaskDelete(temp); // Make sure this is the last line because an AO can be
                        // de-init inside its handler
   }
@@ -149,42 +1080,292 @@ uint8_t ao_get_data_size(ao_t ao) {
 
 int ao_send_message(ao_t receiver, ao_t sender, uint8_t *ao_msg,
                     uint8_t ao_msg_size) {
+  return ao_send_message_ex(receiver, sender, ao_msg, ao_msg_size,
+                            AO_POLICY_DEFAULT, 0);
+}
+
+int ao_send_message_ex(ao_t receiver, ao_t sender, uint8_t *ao_msg,
+                       uint8_t ao_msg_size, ao_policy_t policy,
+                       uint32_t timeout_ms) {
   if (!receiver)
     return AO_E_ARG; // Sender its optional
-  if ((receiver->ao_queue == NULL && !sender) && sender->ao_queue == NULL)
+  if (!ao_has_inbox(receiver) && (!sender || !ao_has_inbox(sender)))
     return AO_E_SENDER; // If receiver does not use queue we must need a sender
                         // with queue in use.
   if (ao_msg == NULL)
     return AO_E_ARG;
   if (ao_msg_size == 0)
     return AO_E_ARG;
-  if (ao_msg_size > 0 && ao_msg == NULL)
+  if (ao_msg_size > AO_MAX_MSG_SIZE)
     return AO_E_SIZE;
+  if (policy > AO_POLICY_BLOCK)
+    return AO_E_ARG;
+  if (ao_sys.replay.task != NULL)
+    return ao_replay_post(receiver, sender, ao_msg, ao_msg_size);
 
-  int err = AO_OK;
-  ao_msg_t *ao_msg_o = pvPortMalloc(sizeof(*ao_msg_o));
-  memset(ao_msg_o, 0, sizeof(*ao_msg_o));
+  int err = ao_admit(receiver, sender);
+  if (err != AO_OK)
+    return err;
+  trace_recorder_put(TRACE_REC_AO_POST, ao_index(receiver),
+                     ao_trace_arg(sender, ao_msg));
+  ao_journal(receiver, sender, ao_msg, ao_msg_size, false);
+
+  // Give priority to receiver queue before sender.
+  ao_t owner = ao_has_inbox(receiver) ? receiver : sender;
+  TickType_t wait = pdMS_TO_TICKS(timeout_ms);
+
+  if (receiver->ao_op & AO_OP_COALESCE)
+    return ao_mbox_post(receiver, sender, owner, ao_msg, ao_msg_size, policy,
+                        wait);
+
+  ao_event_t ao_ev = {.sender = ao_index(sender),
+                      .receiver = ao_index(receiver),
+                      .size = ao_msg_size};
+  if (ao_msg_size <= AO_EV_PAYLOAD_SIZE) {
+    // Small message, travels by value in the inbox.
+    memcpy(ao_ev.payload, ao_msg, ao_msg_size);
+    return ao_post(owner, &ao_ev, policy, wait);
+  }
+
+  int block = ao_pool_take();
+  if (block < 0) {
+    ao_unadmit(ao_ev.receiver, ao_ev.sender);
+    return AO_E_NO_MEM;
+  }
 
+  ao_msg_t *ao_msg_o = &ao_sys.pool[block];
+  memset(ao_msg_o, 0, sizeof(*ao_msg_o));
   ao_msg_o->sender = sender;
   ao_msg_o->receiver = receiver;
   memcpy(ao_msg_o->ao_msg, ao_msg, ao_msg_size);
-  ao_msg_size = ao_msg_size;
+  ao_msg_o->ao_msg_size = ao_msg_size;
 
-  // Give priority to receiver queue before sender.
-  QueueHandle_t hqueue =
-      receiver->ao_queue == NULL ? sender->ao_queue : receiver->ao_queue;
+  ao_ev.flags = AO_MSG_F_POOL;
+  ao_ev.payload[0] = (uint8_t)block;
+  return ao_post(owner, &ao_ev, policy, wait);
+}
+
+int ao_set_overflow_policy(ao_t ao, ao_policy_t policy, uint32_t timeout_ms,
+                           ao_overflow_handler_t ao_overflow_f) {
+  if (ao == NULL || !ao_has_inbox(ao))
+    return AO_E_ARG;
+  if (policy == AO_POLICY_DEFAULT || policy > AO_POLICY_BLOCK)
+    return AO_E_ARG;
+
+  taskENTER_CRITICAL();
+  {
+    ao->ao_policy = policy;
+    ao->ao_wait = pdMS_TO_TICKS(timeout_ms);
+    ao->ao_overflow_f = ao_overflow_f;
+  }
+  taskEXIT_CRITICAL();
+  return AO_OK;
+}
 
-  BaseType_t rt = xQueueSend(hqueue, &ao_msg_o, 0);
-  if (rt == pdFAIL)
-    err = AO_E_OS;
+int ao_set_rate_limit(ao_t receiver, ao_t sender, uint16_t rate_per_s,
+                      uint8_t burst) {
+  if (receiver == NULL)
+    return AO_E_ARG;
+  if (rate_per_s != 0 && burst == 0)
+    return AO_E_ARG;
 
+  uint8_t r = ao_index(receiver), s = ao_index(sender);
+  int err = AO_OK;
+  taskENTER_CRITICAL();
+  {
+    ao_rate_t *rate = ao_rate_find(r, s);
+    for (uint8_t i = 0; rate == NULL && i < AO_MAX_RATE_LIMITS; i++) {
+      if (ao_sys.rate[i].rate == 0)
+        rate = &ao_sys.rate[i];
+    }
+    if (rate == NULL) {
+      err = (rate_per_s == 0) ? AO_OK : AO_E_NO_MEM;
+    } else {
+      // Start with a full bucket.
+      rate->rate = rate_per_s;
+      rate->burst = burst;
+      rate->sender = s;
+      rate->receiver = r;
+      rate->tokens = (uint32_t)burst * configTICK_RATE_HZ;
+      rate->last = xTaskGetTickCount();
+    }
+  }
+  taskEXIT_CRITICAL();
   return err;
 }
 
+int ao_set_admission(ao_t receiver, uint8_t max_pending) {
+  if (receiver == NULL)
+    return AO_E_ARG;
+  receiver->ao_admit_max = max_pending;
+  return AO_OK;
+}
+
+void ao_get_throttle_stats(ao_t ao, ao_throttle_stats_t *stats) {
+  if (ao == NULL || stats == NULL)
+    return;
+  taskENTER_CRITICAL();
+  *stats = ao->ao_throttle;
+  taskEXIT_CRITICAL();
+}
+
+void ao_get_overflow_stats(ao_t ao, ao_overflow_stats_t *stats) {
+  if (ao == NULL || stats == NULL)
+    return;
+  taskENTER_CRITICAL();
+  *stats = ao->ao_stats;
+  taskEXIT_CRITICAL();
+}
+
+int ao_set_deadline(ao_t ao, uint32_t wait_us, uint32_t run_us,
+                    ao_deadline_handler_t ao_deadline_f) {
+  if (ao == NULL)
+    return AO_E_ARG;
+#if 1 != AO_EV_STAMP
+  if (wait_us != 0)
+    return AO_E_ARG; // Events do not carry their post time.
+#endif
+
+  taskENTER_CRITICAL();
+  {
+    ao->ao_wait_budget = wait_us * cycles_per_us;
+    ao->ao_run_budget = run_us * cycles_per_us;
+    ao->ao_deadline_f = ao_deadline_f;
+  }
+  taskEXIT_CRITICAL();
+  return AO_OK;
+}
+
+void ao_get_deadline_stats(ao_t ao, ao_deadline_stats_t *stats) {
+  if (ao == NULL || stats == NULL)
+    return;
+  taskENTER_CRITICAL();
+  *stats = ao->ao_deadline;
+  taskEXIT_CRITICAL();
+}
+
+int ao_get_deadline_miss(ao_t ao, ao_deadline_miss_t *ao_miss) {
+  if (ao == NULL || ao_miss == NULL)
+    return AO_E_ARG;
+  int err = AO_E_ARG;
+  taskENTER_CRITICAL();
+  if (ao->ao_miss.ao_msg.receiver != NULL) {
+    *ao_miss = ao->ao_miss;
+    err = AO_OK;
+  }
+  taskEXIT_CRITICAL();
+  return err;
+}
+
+int ao_call(ao_t receiver, ao_t sender, uint8_t *ao_msg,
+            uint8_t ao_msg_size) {
+  if (!receiver)
+    return AO_E_ARG;
+  // A deinit AO keeps its ops and handler, not its data.
+  if (!receiver->used || !(receiver->ao_op & AO_OP_SYNC))
+    return AO_E_RECEIVER;
+  if (ao_msg == NULL || ao_msg_size == 0)
+    return AO_E_ARG;
+  if (ao_msg_size > AO_MAX_MSG_SIZE)
+    return AO_E_SIZE;
+
+  ao_msg_t ao_msg_o = {
+      .sender = sender,
+      .receiver = receiver,
+      .ao_msg_size = ao_msg_size,
+      .ao_msg_flags = AO_MSG_F_NO_FREE,
+  };
+  memcpy(ao_msg_o.ao_msg, ao_msg, ao_msg_size);
+  ao_journal(receiver, sender, ao_msg, ao_msg_size, true);
+
+  if (receiver->ao_op & AO_OP_COALESCE) {
+    // Its doorbell, if any, finds the mailbox empty.
+    taskENTER_CRITICAL();
+    receiver->ao_mbox_pending = false;
+    taskEXIT_CRITICAL();
+  }
+
+  ao_run(&ao_msg_o, ao_now());
+  return AO_OK;
+}
+
+uint8_t ao_get_id(ao_t ao) { return ao_index(ao); }
+
+ao_t ao_get_by_id(uint8_t id) {
+  if (id >= AO_MAX_OBJECTS || !ao_sys.ao_ins[id].used)
+    return NULL;
+  return &ao_sys.ao_ins[id];
+}
+
+int ao_replay_begin(void) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  if (task == NULL)
+    return AO_E_OS; // Needs the scheduler.
+
+  int err = AO_OK;
+  taskENTER_CRITICAL();
+  if (ao_sys.replay.task != NULL) {
+    err = AO_E_ARG; // Another replay runs.
+  } else {
+    ao_sys.replay.head = 0;
+    ao_sys.replay.count = 0;
+    ao_sys.replay.task = task;
+  }
+  taskEXIT_CRITICAL();
+  return err;
+}
+
+int ao_replay_dispatch(ao_t receiver, ao_t sender, const uint8_t *ao_msg,
+                       uint8_t ao_msg_size, uint32_t now) {
+  ao_replay_t *replay = &ao_sys.replay;
+  if (!ao_replaying())
+    return AO_E_OS;
+  if (receiver == NULL || !receiver->used)
+    return AO_E_RECEIVER;
+  if (ao_msg == NULL || ao_msg_size == 0)
+    return AO_E_ARG;
+  if (ao_msg_size > AO_MAX_MSG_SIZE)
+    return AO_E_SIZE;
+
+  replay->now = now;
+  replay->dropped = false;
+  ao_msg_t ao_msg_o = {
+      .sender = sender,
+      .receiver = receiver,
+      .ao_msg_size = ao_msg_size,
+      .ao_msg_flags = AO_MSG_F_NO_FREE,
+  };
+  memcpy(ao_msg_o.ao_msg, ao_msg, ao_msg_size);
+  ao_run(&ao_msg_o, now);
+
+  // Then what the handlers posted, which can post in turn.
+  while (replay->count > 0) {
+    ao_msg_o = replay->queue[replay->head];
+    replay->head = (replay->head + 1U) % AO_REPLAY_QUEUE_LEN;
+    replay->count--;
+    if (ao_msg_o.receiver->used) // Not deinit meanwhile.
+      ao_run(&ao_msg_o, now);
+  }
+  return replay->dropped ? AO_E_FULL : AO_OK;
+}
+
+void ao_replay_end(void) {
+  if (!ao_replaying())
+    return;
+  ao_sys.replay.count = 0;
+  ao_sys.replay.task = NULL;
+}
+
 void ao_sender_free_method(ao_t ao, ao_msg_t *ao_msg) {
   if (ao == NULL || ao->ao_free_f == NULL)
     return;
+  if (ao_msg->ao_msg_flags & AO_MSG_F_NO_FREE)
+    return; // Storage owned by the AO core.
   ao->ao_free_f(ao_msg);
 }
 
-void ao_generic_free_message(ao_msg_t *ao_msg) { vPortFree(ao_msg); }
+void ao_generic_free_message(ao_msg_t *ao_msg) {
+  if (ao_msg->ao_msg_flags & AO_MSG_F_NO_FREE)
+    return;
+  vPortFree(ao_msg);
+}
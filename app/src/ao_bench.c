@@ -0,0 +1,131 @@
+/*
+ * ao_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "ao_bench.h"
+#include "ao_api.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "linker_sections.h"
+#include "logger.h"
+#include "main.h"
+
+#if 1 == AO_BENCH_CONFIG_ENABLE
+
+typedef struct {
+  uint32_t min;
+  uint32_t max;
+  uint32_t sum;
+  uint32_t count;
+} ao_bench_stat_t;
+
+static struct {
+  volatile uint32_t stamp; /*< Cycle counter at the measured end point */
+  TaskHandle_t ping;
+} ao_bench;
+
+static void ao_bench_add_(ao_bench_stat_t *stat, uint32_t cycles) {
+  if (stat->count == 0 || cycles < stat->min)
+    stat->min = cycles;
+  if (cycles > stat->max)
+    stat->max = cycles;
+  stat->sum += cycles;
+  stat->count++;
+}
+
+static void ao_bench_log_(const char *name, const ao_bench_stat_t *stat) {
+  LOGGER_INFO("  %s min %lu avg %lu max %lu", name, (unsigned long)stat->min,
+              (unsigned long)(stat->count ? stat->sum / stat->count : 0),
+              (unsigned long)stat->max);
+}
+
+static const char *ao_bench_heap_(void) {
+#if (configHEAP_SCHEME == configHEAP_SCHEME_HEAP_5)
+  return "CCM then SRAM";
+#else
+  return LINKER_CONFIG_HEAP_IN_CCM ? "CCM" : "SRAM";
+#endif
+}
+
+static void ao_bench_ev_f(ao_msg_t *ao_msg) {
+  ao_bench.stamp = cycle_counter_get();
+}
+
+static void ao_bench_ping_(void *argument) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    ao_bench.stamp = cycle_counter_get();
+  }
+}
+
+/**
+ * @brief Measure the inbox of an AO built with ao_op.
+ *
+ * @param name Inbox name for the log.
+ * @param ao_op AO option flags.
+ */
+static void ao_bench_inbox_(const char *name, ao_op_t ao_op) {
+  ao_bench_stat_t post = {0}, dispatch = {0};
+
+  const ao_config_t ao_cfg = {.name = name};
+  ao_t ao = ao_init(NULL, 0, ao_bench_ev_f, NULL, ao_op, &ao_cfg);
+  for (uint32_t i = 0; ao != NULL && i < AO_BENCH_CONFIG_SAMPLES; i++) {
+    uint8_t msg = (uint8_t)i;
+
+    // Post alone, the AO task can not run until the scheduler resumes.
+    vTaskSuspendAll();
+    uint32_t start = cycle_counter_get();
+    int rt = ao_send_message(ao, NULL, &msg, sizeof(msg));
+    uint32_t end = cycle_counter_get();
+    xTaskResumeAll();
+    if (rt == AO_OK)
+      ao_bench_add_(&post, end - start);
+    vTaskDelay(1);
+
+    // Post and wake up, the AO task preempts this one before the call returns.
+    start = cycle_counter_get();
+    if (ao_send_message(ao, NULL, &msg, sizeof(msg)) == AO_OK)
+      ao_bench_add_(&dispatch, ao_bench.stamp - start);
+    vTaskDelay(1); // Let lower priority work run between samples.
+  }
+
+  LOGGER_INFO(" %s inbox", name);
+  ao_bench_log_("post    ", &post);
+  ao_bench_log_("dispatch", &dispatch);
+
+  if (ao != NULL)
+    ao_deinit(ao);
+}
+
+static void ao_bench_task_(void *argument) {
+  ao_bench_stat_t ctx_switch = {0};
+
+  LOGGER_INFO("AO bench (cycles), heap in %s", ao_bench_heap_());
+  ao_bench_inbox_("queue", 0);
+  ao_bench_inbox_("lock-free", AO_OP_LOCKFREE);
+
+  // Runs above this task, so each measure ends before the call returns.
+  xTaskCreate(ao_bench_ping_, "ao_bench_ping", configMINIMAL_STACK_SIZE, NULL,
+              tskIDLE_PRIORITY + 2, &ao_bench.ping);
+  for (uint32_t i = 0; i < AO_BENCH_CONFIG_SAMPLES; i++) {
+    uint32_t start = cycle_counter_get();
+    xTaskNotifyGive(ao_bench.ping);
+    ao_bench_add_(&ctx_switch, ao_bench.stamp - start);
+    vTaskDelay(1);
+  }
+  ao_bench_log_("switch  ", &ctx_switch);
+
+  vTaskDelete(ao_bench.ping);
+  vTaskDelete(NULL);
+}
+
+#endif
+
+void ao_bench_start(void) {
+#if 1 == AO_BENCH_CONFIG_ENABLE
+  xTaskCreate(ao_bench_task_, "ao_bench", configMINIMAL_STACK_SIZE, NULL,
+              tskIDLE_PRIORITY, NULL);
+#endif
+}
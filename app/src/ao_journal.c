@@ -0,0 +1,297 @@
+/*
+ * ao_journal.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "ao_journal.h"
+#include "ao_api.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "linker_sections.h"
+#include "logger.h"
+#include "main.h"
+#include <string.h>
+
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+
+/*< Journal memory, entries oldest at 'head' % capacity once wrapped */
+typedef struct {
+  uint32_t capacity; /*< AO_JOURNAL_CONFIG_ENTRIES */
+  uint32_t head;     /*< Entries written since the start */
+  ao_journal_entry_t entry[AO_JOURNAL_CONFIG_ENTRIES];
+} ao_journal_buffer_t;
+
+_Static_assert((AO_JOURNAL_CONFIG_ENTRIES &
+                (AO_JOURNAL_CONFIG_ENTRIES - 1)) == 0,
+               "AO journal entries must be a power of two");
+
+/*< Not static, the debugger dumps it by name */
+ao_journal_buffer_t ao_journal_buffer LINKER_SECTION_CCM;
+
+static struct {
+  volatile bool running;
+  /* Replay check, what the handlers post against the journaled entries */
+  const ao_journal_entry_t *expect;
+  uint32_t expect_count;
+  uint32_t expect_next;        /*< Next entry to look at */
+  uint8_t gen[AO_MAX_OBJECTS]; /*< Generation replayed of each slot */
+  ao_journal_replay_stats_t *stats;
+} ao_journal;
+
+/**
+ * @brief Whether a journaled AO id is of the generation replayed.
+ *
+ * @param id Journaled id or AO_JOURNAL_NO_AO.
+ * @return true for no AO or the AO replayed in its slot.
+ */
+static bool ao_journal_replayed_(uint8_t id) {
+  if (id == AO_JOURNAL_NO_AO)
+    return true;
+  uint8_t slot = AO_JOURNAL_SLOT(id);
+  return slot < AO_MAX_OBJECTS && ao_journal.gen[slot] == AO_JOURNAL_GEN(id);
+}
+
+/**
+ * @brief Whether an entry is expected to be posted again by the handlers:
+ * posted by one of them, between AOs of the generations replayed.
+ *
+ * @param entry Journaled entry.
+ * @return true if the replay must post it.
+ */
+static bool ao_journal_expected_(const ao_journal_entry_t *entry) {
+  return !(entry->flags & AO_JOURNAL_F_ROOT) &&
+         ao_journal_replayed_(entry->sender) &&
+         ao_journal_replayed_(entry->receiver);
+}
+
+/**
+ * @brief Whether two journaled ids name the same slot. The AOs of a replay
+ * are fresh, their generations are not the journaled ones.
+ *
+ * @param a Journaled id or AO_JOURNAL_NO_AO.
+ * @param b Journaled id or AO_JOURNAL_NO_AO.
+ * @return true if both are no AO or the same slot.
+ */
+static bool ao_journal_same_ao_(uint8_t a, uint8_t b) {
+  if (a == AO_JOURNAL_NO_AO || b == AO_JOURNAL_NO_AO)
+    return a == b;
+  return AO_JOURNAL_SLOT(a) == AO_JOURNAL_SLOT(b);
+}
+
+/**
+ * @brief Check a message posted by a handler during a replay.
+ *
+ * @param entry Message as it would be journaled.
+ */
+static void ao_journal_expect_(const ao_journal_entry_t *entry) {
+  ao_journal_replay_stats_t *stats = ao_journal.stats;
+  stats->nested++;
+  if (stats->diverged)
+    return; // Only the first difference tells something.
+
+  // Next entry posted by a handler, roots are fed by the replay itself.
+  while (ao_journal.expect_next < ao_journal.expect_count &&
+         !ao_journal_expected_(&ao_journal.expect[ao_journal.expect_next]))
+    ao_journal.expect_next++;
+
+  uint32_t at = ao_journal.expect_next;
+  if (at == ao_journal.expect_count) {
+    // Posted past the journal end, e.g. the field run was cut there.
+    return;
+  }
+  const ao_journal_entry_t *expect = &ao_journal.expect[at];
+  ao_journal.expect_next++;
+  if (!ao_journal_same_ao_(expect->sender, entry->sender) ||
+      !ao_journal_same_ao_(expect->receiver, entry->receiver) ||
+      expect->size != entry->size || expect->flags != entry->flags ||
+      memcmp(expect->payload, entry->payload, entry->size) != 0) {
+    stats->diverged = true;
+    stats->diverged_at = at;
+  }
+}
+
+/**
+ * @brief Move the check up to a root entry, the posts journaled before it
+ * were not posted again.
+ *
+ * @param root Root entry about to be fed, or the journal end.
+ */
+static void ao_journal_align_(uint32_t root) {
+  ao_journal_replay_stats_t *stats = ao_journal.stats;
+  for (; ao_journal.expect_next < root; ao_journal.expect_next++) {
+    const ao_journal_entry_t *expect =
+        &ao_journal.expect[ao_journal.expect_next];
+    if (!stats->diverged && ao_journal_expected_(expect)) {
+      stats->diverged = true;
+      stats->diverged_at = ao_journal.expect_next;
+    }
+  }
+  if (ao_journal.expect_next == root && root < ao_journal.expect_count)
+    ao_journal.expect_next++; // The root itself.
+}
+
+#endif
+
+void ao_journal_start(void) {
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+  taskENTER_CRITICAL();
+  {
+    ao_journal_buffer.capacity = AO_JOURNAL_CONFIG_ENTRIES;
+    ao_journal_buffer.head = 0;
+    ao_journal.running = true;
+  }
+  taskEXIT_CRITICAL();
+#endif
+}
+
+void ao_journal_stop(void) {
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+  ao_journal.running = false;
+#endif
+}
+
+void ao_journal_put(uint8_t sender, uint8_t receiver, const uint8_t *ao_msg,
+                    uint8_t ao_msg_size, uint8_t flags) {
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+  if (ao_msg_size > AO_MAX_MSG_SIZE)
+    return;
+
+  ao_journal_entry_t entry = {.cyc = cycle_counter_get(),
+                              .sender = sender,
+                              .receiver = receiver,
+                              .size = ao_msg_size,
+                              .flags = flags};
+  memcpy(entry.payload, ao_msg, ao_msg_size);
+
+  if (ao_journal.stats != NULL) {
+    // Replaying, only the replay task posts.
+    ao_journal_expect_(&entry);
+    return;
+  }
+  if (!ao_journal.running)
+    return;
+
+  taskENTER_CRITICAL();
+  {
+    uint32_t head = ao_journal_buffer.head;
+    ao_journal_buffer.entry[head & (AO_JOURNAL_CONFIG_ENTRIES - 1U)] = entry;
+    ao_journal_buffer.head = head + 1U;
+  }
+  taskEXIT_CRITICAL();
+#endif
+}
+
+uint32_t ao_journal_read(ao_journal_entry_t *entries, uint32_t max) {
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+  if (entries == NULL)
+    return 0;
+
+  // Entries are put by tasks only, none meanwhile.
+  vTaskSuspendAll();
+  uint32_t head = ao_journal_buffer.head;
+  uint32_t count =
+      head < AO_JOURNAL_CONFIG_ENTRIES ? head : AO_JOURNAL_CONFIG_ENTRIES;
+  if (count > max)
+    count = max;
+  // The newest 'count' entries, oldest first.
+  uint32_t first = head - count;
+  for (uint32_t i = 0; i < count; i++)
+    entries[i] =
+        ao_journal_buffer.entry[(first + i) & (AO_JOURNAL_CONFIG_ENTRIES - 1U)];
+  xTaskResumeAll();
+  return count;
+#else
+  return 0;
+#endif
+}
+
+int ao_journal_replay(const ao_journal_entry_t *entries, uint32_t count,
+                      ao_journal_replay_stats_t *stats) {
+#if 1 == AO_JOURNAL_CONFIG_ENABLE
+  if ((entries == NULL && count > 0) || stats == NULL)
+    return AO_E_ARG;
+
+  int err = ao_replay_begin();
+  if (err != AO_OK)
+    return err;
+
+  bool running = ao_journal.running;
+  ao_journal.running = false;
+  memset(stats, 0, sizeof(*stats));
+  ao_journal.expect = entries;
+  ao_journal.expect_count = count;
+  ao_journal.stats = stats;
+  // The last AO journaled in each slot is the one replayed.
+  memset(ao_journal.gen, 0, sizeof(ao_journal.gen));
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t ids[] = {entries[i].sender, entries[i].receiver};
+    for (uint8_t k = 0; k < sizeof(ids); k++) {
+      uint8_t slot = AO_JOURNAL_SLOT(ids[k]);
+      if (slot < AO_MAX_OBJECTS) // The one of no AO is past them.
+        ao_journal.gen[slot] = AO_JOURNAL_GEN(ids[k]);
+    }
+  }
+  // A wrapped journal can start with posts whose root was overwritten.
+  ao_journal.expect_next = 0;
+  while (ao_journal.expect_next < count &&
+         !(entries[ao_journal.expect_next].flags & AO_JOURNAL_F_ROOT))
+    ao_journal.expect_next++;
+
+  for (uint32_t i = 0; i < count; i++) {
+    const ao_journal_entry_t *entry = &entries[i];
+    if (!(entry->flags & AO_JOURNAL_F_ROOT))
+      continue;
+    // What it posts is journaled after it.
+    if (ao_journal.expect_next <= i)
+      ao_journal_align_(i);
+
+    // Roots of an AO the slot held before, e.g. the idle of a previous UI.
+    ao_t receiver = ao_get_by_id(AO_JOURNAL_SLOT(entry->receiver));
+    if (receiver == NULL || !ao_journal_replayed_(entry->receiver) ||
+        !ao_journal_replayed_(entry->sender)) {
+      stats->skipped++;
+      continue;
+    }
+    ao_t sender = entry->sender == AO_JOURNAL_NO_AO
+                      ? NULL
+                      : ao_get_by_id(AO_JOURNAL_SLOT(entry->sender));
+
+    // Messages of ao_call from outside handlers run the same, in the caller.
+    uint32_t start = cycle_counter_get();
+    ao_replay_dispatch(receiver, sender, entry->payload, entry->size,
+                       entry->cyc);
+    uint32_t run = cycle_counter_get() - start;
+    stats->roots++;
+    stats->run_total += run;
+    if (run > stats->run_max)
+      stats->run_max = run;
+  }
+
+  ao_journal_align_(count);
+  ao_journal.stats = NULL;
+  ao_journal.expect = NULL;
+  ao_replay_end();
+  if (running)
+    ao_journal_start();
+  return AO_OK;
+#else
+  return AO_E_ARG;
+#endif
+}
+
+void ao_journal_report(const ao_journal_replay_stats_t *stats) {
+  if (stats == NULL)
+    return;
+  LOGGER_INFO("Replay: fed %lu skipped %lu posted %lu",
+              (unsigned long)stats->roots, (unsigned long)stats->skipped,
+              (unsigned long)stats->nested);
+  LOGGER_INFO("  run %lu us, worst %lu us",
+              (unsigned long)(stats->run_total / cycles_per_us),
+              (unsigned long)(stats->run_max / cycles_per_us));
+  if (stats->diverged) {
+    LOGGER_INFO("  diverged at entry %lu", (unsigned long)stats->diverged_at);
+  } else {
+    LOGGER_INFO("  same messages as journaled");
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * ao_state.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "ao_state.h"
+#include "ao_api.h"
+#include "main.h"
+
+/*< Every value bit of the event group */
+#define AO_STATE_ALL_BITS_ (AO_STATE_BIT(AO_STATE_MAX_VALUES) - 1UL)
+
+int ao_state_init(ao_state_t *state, uint32_t value) {
+  if (state == NULL)
+    return AO_E_ARG;
+  if (state->events == NULL) {
+    state->events = xEventGroupCreate();
+    if (state->events == NULL)
+      return AO_E_OS;
+  }
+  return ao_state_publish(state, value);
+}
+
+int ao_state_publish(ao_state_t *state, uint32_t value) {
+  if (state == NULL || state->events == NULL)
+    return AO_E_ARG;
+  if (value >= AO_STATE_MAX_VALUES)
+    return AO_E_ARG;
+
+  state->value = value;
+  __DMB(); // Readers woken below see the new value.
+  // Clear before set, a waiter never sees two values at once.
+  xEventGroupClearBits(state->events,
+                       AO_STATE_ALL_BITS_ & ~AO_STATE_BIT(value));
+  xEventGroupSetBits(state->events, AO_STATE_BIT(value));
+  return AO_OK;
+}
+
+uint32_t ao_state_get(const ao_state_t *state) {
+  if (state == NULL)
+    return 0;
+  return state->value;
+}
+
+bool ao_state_wait(ao_state_t *state, uint32_t mask, uint32_t timeout_ms) {
+  if (state == NULL || state->events == NULL)
+    return false;
+
+  TickType_t ticks = (timeout_ms == AO_STATE_WAIT_FOREVER)
+                         ? portMAX_DELAY
+                         : pdMS_TO_TICKS(timeout_ms);
+  EventBits_t bits = xEventGroupWaitBits(
+      state->events, mask & AO_STATE_ALL_BITS_, pdFALSE, pdFALSE, ticks);
+  return (bits & mask) != 0;
+}
@@ -46,9 +46,19 @@
 #include "task_ui.h"
 
 #include "ao_api.h"
+#include "ao_bench.h"
+#include "ao_journal.h"
+#include "heap_bench.h"
+#include "heap_regions.h"
+#include "irq_bench.h"
+#include "led_pattern.h"
+#include "stack_monitor.h"
+#include "trace_recorder.h"
 
 /********************** macros and definitions *******************************/
 
+#define TASK_BUTTON_STACK_SIZE_ (128)
+
 /********************** internal data declaration ****************************/
 
 /********************** internal functions declaration ***********************/
@@ -58,31 +68,41 @@
 /********************** external data declaration *****************************/
 ao_t ao_ui;
 
-SemaphoreHandle_t os_sem_h;
-
 /********************** external functions definition ************************/
 void app_init(void) {
   BaseType_t status;
 
-  // Semaphore to safeguard resources
-  os_sem_h = xSemaphoreCreateBinary();
-  xSemaphoreGive(os_sem_h);
+  // RTOS heap regions, before anything is allocated
+  heap_regions_init();
+
+  // Led patterns are played by timer and DMA, prepare them before any led AO
+  led_pattern_init();
 
   // Initialize user interface
   ao_ui = ao_ui_init();
   // Initialize 'n' AO_leds
 
   // Create task button
-  status = xTaskCreate(task_button, "task_button", 128, NULL,
-                       tskIDLE_PRIORITY + 3, NULL);
+  TaskHandle_t task_button_h;
+  status = xTaskCreate(task_button, "task_button", TASK_BUTTON_STACK_SIZE_,
+                       NULL, tskIDLE_PRIORITY + 3, &task_button_h);
 
   while (pdPASS != status) {
     // error
   }
+  stack_monitor_register(task_button_h, "task_button", TASK_BUTTON_STACK_SIZE_);
 
   LOGGER_INFO("Application initialized");
 
   cycle_counter_init();
+  // Records are stamped with the cycle counter
+  trace_recorder_init();
+  ao_journal_start();
+
+  // Scheduler not started yet, nothing disturbs the measures
+  heap_bench_run();
+  ao_bench_start();
+  irq_bench_start();
 }
 
 /********************** end of file ******************************************/
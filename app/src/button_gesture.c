@@ -0,0 +1,181 @@
+/*
+ * button_gesture.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "button_gesture.h"
+#include <string.h>
+
+typedef enum {
+  BUTTON_GESTURE_ST_IDLE = 0,
+  BUTTON_GESTURE_ST_PRESSED,     /*< Pressed, nothing reported yet */
+  BUTTON_GESTURE_ST_HELD,        /*< Long reported, repeating */
+  BUTTON_GESTURE_ST_WAIT_DOUBLE, /*< Pulse released, waiting a second click */
+  BUTTON_GESTURE_ST_CHORD,       /*< Part of a chord, ignored until release */
+} button_gesture_st_t;
+
+typedef struct {
+  button_gesture_st_t st;
+  bool second;      /*< Second click of a double click */
+  uint32_t time_ms; /*< Time in the current state */
+  uint16_t repeat;  /*< Repeats reported while held */
+} button_gesture_btn_t;
+
+typedef struct {
+  button_gesture_cfg_t cfg;
+  button_gesture_btn_t btn[BUTTON_SCAN_MAX_BUTTONS];
+  button_gesture_ev_t *ev;
+  uint8_t ev_count;
+  uint8_t ev_max;
+} button_gesture_t;
+
+static button_gesture_t button_gesture;
+
+/**
+ * @brief Report a gesture.
+ *
+ * @param type Gesture type.
+ * @param buttons Buttons of the gesture.
+ * @param repeat Repeat count.
+ */
+static void button_gesture_emit(button_gesture_type_t type,
+                                button_mask_t buttons, uint16_t repeat) {
+  if (button_gesture.ev_count >= button_gesture.ev_max)
+    return;
+  button_gesture_ev_t *ev = &button_gesture.ev[button_gesture.ev_count++];
+  ev->type = type;
+  ev->buttons = buttons;
+  ev->repeat = repeat;
+}
+
+/**
+ * @brief Classify a released press.
+ *
+ * @param btn Button state.
+ * @param b Button mask.
+ */
+static void button_gesture_release(button_gesture_btn_t *btn, button_mask_t b) {
+  const button_gesture_cfg_t *cfg = &button_gesture.cfg;
+  button_gesture_st_t next = BUTTON_GESTURE_ST_IDLE;
+
+  if (btn->second) {
+    if (btn->time_ms < cfg->short_ms) {
+      button_gesture_emit(BUTTON_GESTURE_DOUBLE, b, 0);
+      btn->st = BUTTON_GESTURE_ST_IDLE;
+      return;
+    }
+    // Too slow for a double click. The first click was a pulse.
+    button_gesture_emit(BUTTON_GESTURE_PULSE, b, 0);
+  }
+
+  if (btn->time_ms >= cfg->short_ms) {
+    button_gesture_emit(BUTTON_GESTURE_SHORT, b, 0);
+  } else if (btn->time_ms >= cfg->pulse_ms) {
+    if (cfg->double_ms != 0 && !btn->second)
+      next = BUTTON_GESTURE_ST_WAIT_DOUBLE;
+    else
+      button_gesture_emit(BUTTON_GESTURE_PULSE, b, 0);
+  }
+  btn->st = next;
+  btn->time_ms = 0;
+}
+
+/**
+ * @brief Advance the time of a button without edges.
+ *
+ * @param btn Button state.
+ * @param b Button mask.
+ * @param period_ms Elapsed time.
+ */
+static void button_gesture_tick(button_gesture_btn_t *btn, button_mask_t b,
+                                uint16_t period_ms) {
+  const button_gesture_cfg_t *cfg = &button_gesture.cfg;
+  btn->time_ms += period_ms;
+
+  switch (btn->st) {
+  case BUTTON_GESTURE_ST_PRESSED: {
+    if (btn->time_ms >= cfg->long_ms) {
+      if (btn->second)
+        button_gesture_emit(BUTTON_GESTURE_PULSE, b, 0);
+      // Decidable now, do not wait for the release.
+      button_gesture_emit(BUTTON_GESTURE_LONG, b, 0);
+      btn->st = BUTTON_GESTURE_ST_HELD;
+      btn->second = false;
+      btn->time_ms = 0;
+      btn->repeat = 0;
+    }
+    break;
+  }
+  case BUTTON_GESTURE_ST_HELD: {
+    uint32_t wait = btn->repeat == 0 ? cfg->repeat_delay_ms : cfg->repeat_ms;
+    if (cfg->repeat_ms != 0 && btn->time_ms >= wait) {
+      btn->repeat++;
+      button_gesture_emit(BUTTON_GESTURE_REPEAT, b, btn->repeat);
+      btn->time_ms = 0;
+    }
+    break;
+  }
+  case BUTTON_GESTURE_ST_WAIT_DOUBLE: {
+    if (btn->time_ms >= cfg->double_ms) {
+      button_gesture_emit(BUTTON_GESTURE_PULSE, b, 0);
+      btn->st = BUTTON_GESTURE_ST_IDLE;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void button_gesture_init(const button_gesture_cfg_t *cfg) {
+  memset(&button_gesture, 0, sizeof(button_gesture));
+  button_gesture.cfg = *cfg;
+}
+
+uint8_t button_gesture_update(const button_scan_ev_t *scan, uint16_t period_ms,
+                              button_gesture_ev_t *ev, uint8_t max_ev) {
+  button_gesture.ev = ev;
+  button_gesture.ev_count = 0;
+  button_gesture.ev_max = max_ev;
+
+  for (uint8_t i = 0; i < BUTTON_SCAN_MAX_BUTTONS; i++) {
+    button_gesture_btn_t *btn = &button_gesture.btn[i];
+    button_mask_t b = BUTTON_MASK(i);
+
+    if (scan->pressed & b) {
+      btn->second = (btn->st == BUTTON_GESTURE_ST_WAIT_DOUBLE);
+      btn->st = BUTTON_GESTURE_ST_PRESSED;
+      btn->time_ms = 0;
+    } else if (scan->released & b) {
+      if (btn->st == BUTTON_GESTURE_ST_PRESSED)
+        button_gesture_release(btn, b);
+      else
+        btn->st = BUTTON_GESTURE_ST_IDLE; // Long or chord already reported.
+    } else if (btn->st != BUTTON_GESTURE_ST_IDLE) {
+      button_gesture_tick(btn, b, period_ms);
+    }
+  }
+
+  // A new press joining presses younger than the chord window makes a chord.
+  // Its buttons stop producing single button gestures until released.
+  if (scan->pressed != 0 && button_gesture.cfg.chord_ms != 0) {
+    button_mask_t chord = 0;
+    for (uint8_t i = 0; i < BUTTON_SCAN_MAX_BUTTONS; i++) {
+      button_gesture_btn_t *btn = &button_gesture.btn[i];
+      if ((btn->st == BUTTON_GESTURE_ST_PRESSED &&
+           btn->time_ms <= button_gesture.cfg.chord_ms) ||
+          btn->st == BUTTON_GESTURE_ST_CHORD)
+        chord |= BUTTON_MASK(i);
+    }
+    if (__builtin_popcount(chord) >= 2) {
+      button_gesture_emit(BUTTON_GESTURE_CHORD, chord, 0);
+      for (uint8_t i = 0; i < BUTTON_SCAN_MAX_BUTTONS; i++) {
+        if (chord & BUTTON_MASK(i))
+          button_gesture.btn[i].st = BUTTON_GESTURE_ST_CHORD;
+      }
+    }
+  }
+
+  return button_gesture.ev_count;
+}
@@ -0,0 +1,145 @@
+/*
+ * button_scan.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "button_scan.h"
+#include "board.h"
+#include <string.h>
+
+typedef struct {
+  GPIO_TypeDef *port; /*< GPIO port */
+  uint16_t pins;      /*< Button pins in this port */
+  uint16_t state;     /*< Debounced pressed pins */
+  uint16_t cnt0;      /*< Vertical counter, bit 0 */
+  uint16_t cnt1;      /*< Vertical counter, bit 1 */
+} button_scan_port_t;
+
+typedef struct {
+  uint8_t buttons_count;
+  uint8_t ports_count;
+  uint8_t button_port[BUTTON_SCAN_MAX_BUTTONS]; /*< Port index of each button */
+  uint16_t button_pin[BUTTON_SCAN_MAX_BUTTONS]; /*< Pin of each button */
+  button_mask_t state;                          /*< Debounced buttons state */
+  button_mask_t alias;  /*< Buttons wired to the pin of a previous button */
+  bool injected;        /*< Inputs come from 'inject', not the pins */
+  button_mask_t inject; /*< Injected buttons pressed */
+  button_scan_port_t ports[BUTTON_SCAN_MAX_PORTS];
+} button_scan_t;
+
+static button_scan_t button_scan;
+
+/**
+ * @brief Translate pins of a port into buttons.
+ *
+ * @param p Port index.
+ * @param pins Pins of the port.
+ * @return button_mask_t Buttons wired to those pins.
+ */
+static button_mask_t button_scan_to_mask(uint8_t p, uint16_t pins) {
+  button_mask_t mask = 0;
+  for (uint8_t i = 0; i < button_scan.buttons_count; i++) {
+    if (button_scan.alias & BUTTON_MASK(i))
+      continue;
+    if (button_scan.button_port[i] == p && (button_scan.button_pin[i] & pins))
+      mask |= BUTTON_MASK(i);
+  }
+  return mask;
+}
+
+/**
+ * @brief Translate buttons into pins of a port.
+ *
+ * @param p Port index.
+ * @param mask Buttons.
+ * @return uint16_t Pins of those buttons in the port.
+ */
+static uint16_t button_scan_to_pins(uint8_t p, button_mask_t mask) {
+  uint16_t pins = 0;
+  for (uint8_t i = 0; i < button_scan.buttons_count; i++) {
+    if ((mask & BUTTON_MASK(i)) && button_scan.button_port[i] == p)
+      pins |= button_scan.button_pin[i];
+  }
+  return pins;
+}
+
+int button_scan_init(const button_pin_t *buttons, uint8_t count) {
+  if (buttons == NULL || count == 0 || count > BUTTON_SCAN_MAX_BUTTONS)
+    return -1;
+
+  memset(&button_scan, 0, sizeof(button_scan));
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t p = 0;
+    while (p < button_scan.ports_count &&
+           button_scan.ports[p].port != buttons[i].port)
+      p++;
+    if (p == button_scan.ports_count) {
+      if (p == BUTTON_SCAN_MAX_PORTS)
+        return -1;
+      button_scan.ports[p].port = buttons[i].port;
+      button_scan.ports_count++;
+    }
+    if (button_scan.ports[p].pins & buttons[i].pin)
+      button_scan.alias |= BUTTON_MASK(i);
+    button_scan.ports[p].pins |= buttons[i].pin;
+    button_scan.button_port[i] = p;
+    button_scan.button_pin[i] = buttons[i].pin;
+  }
+  button_scan.buttons_count = count;
+
+  // Vertical counters start at 3 so the first change needs 4 samples.
+  for (uint8_t p = 0; p < button_scan.ports_count; p++) {
+    button_scan.ports[p].cnt0 = 0xFFFFU;
+    button_scan.ports[p].cnt1 = 0xFFFFU;
+  }
+  return 0;
+}
+
+bool button_scan_update(button_scan_ev_t *ev) {
+  button_mask_t pressed = 0, released = 0, settling = 0;
+
+  for (uint8_t p = 0; p < button_scan.ports_count; p++) {
+    button_scan_port_t *port = &button_scan.ports[p];
+
+    // One read samples every button of the port.
+    uint16_t raw;
+    if (button_scan.injected) {
+      raw = button_scan_to_pins(p, button_scan.inject);
+    } else {
+      uint16_t idr = (uint16_t)port->port->IDR;
+      raw = (BUTTON_PRESSED == GPIO_PIN_SET) ? idr : (uint16_t)~idr;
+    }
+    raw &= port->pins;
+
+    // Count down the pins whose sample differs from the debounced state.
+    // Equal samples reset their counter. A pin toggles on counter roll over.
+    uint16_t delta = raw ^ port->state;
+    port->cnt0 = (uint16_t)~(port->cnt0 & delta);
+    port->cnt1 = port->cnt0 ^ (port->cnt1 & delta);
+    uint16_t toggle = delta & port->cnt0 & port->cnt1;
+    port->state ^= toggle;
+    if (delta & (uint16_t)~toggle)
+      settling |= button_scan_to_mask(p, delta & (uint16_t)~toggle);
+
+    if (toggle == 0)
+      continue; // Nothing changed, no per-button work.
+    pressed |= button_scan_to_mask(p, toggle & port->state);
+    released |= button_scan_to_mask(p, toggle & (uint16_t)~port->state);
+  }
+
+  button_scan.state = (button_scan.state | pressed) & (button_mask_t)~released;
+
+  if (ev != NULL) {
+    ev->pressed = pressed;
+    ev->released = released;
+    ev->state = button_scan.state;
+    ev->settling = settling;
+  }
+  return (pressed | released) != 0;
+}
+
+void button_scan_inject(bool enable, button_mask_t pressed) {
+  button_scan.inject = pressed;
+  button_scan.injected = enable;
+}
@@ -0,0 +1,115 @@
+/*
+ * cpu_load.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "cpu_load.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "logger.h"
+#include "main.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*< Full scale of the load */
+#define CPU_LOAD_FULL_ (1000U)
+
+#if 1 == CPU_LOAD_CONFIG_ENABLE
+
+static struct {
+  uint32_t last_call;    /*< Cycle counter at the previous idle hook call */
+  uint32_t window_start; /*< Cycle counter at the window start */
+  uint32_t idle;         /*< Idle cycles in the window */
+  uint32_t loop;         /*< Shortest gap between calls, an idle loop */
+  uint32_t avg;          /*< Smoothed load, scaled by 2^EWMA_SHIFT */
+  bool started;          /*< A window is open */
+  bool sampled;          /*< A window has ended */
+  cpu_load_t load;
+} cpu_load;
+
+/**
+ * @brief End the window if it is over. Call it in a critical section.
+ *
+ * @param now Cycle counter now.
+ */
+static void cpu_load_window_(uint32_t now) {
+  uint32_t elapsed = now - cpu_load.window_start;
+  if (elapsed < CPU_LOAD_CONFIG_WINDOW_MS * cycles_per_us * 1000U)
+    return;
+
+  uint32_t idle = cpu_load.idle < elapsed ? cpu_load.idle : elapsed;
+  uint16_t last = (uint16_t)(CPU_LOAD_FULL_ -
+                             (uint32_t)(((uint64_t)idle * CPU_LOAD_FULL_) /
+                                        elapsed));
+  if (!cpu_load.sampled) {
+    cpu_load.avg = (uint32_t)last << CPU_LOAD_CONFIG_EWMA_SHIFT;
+    cpu_load.sampled = true;
+  } else {
+    // Scaled by 2^shift: avg = avg * (1 - 1 / 2^shift) + last / 2^shift.
+    cpu_load.avg = cpu_load.avg - (cpu_load.avg >> CPU_LOAD_CONFIG_EWMA_SHIFT) +
+                   last;
+  }
+  cpu_load.load.last = last;
+  cpu_load.load.avg = (uint16_t)(cpu_load.avg >> CPU_LOAD_CONFIG_EWMA_SHIFT);
+  if (last > cpu_load.load.peak)
+    cpu_load.load.peak = last;
+  cpu_load.window_start = now;
+  cpu_load.idle = 0;
+}
+
+#endif
+
+void cpu_load_idle(void) {
+#if 1 == CPU_LOAD_CONFIG_ENABLE
+  uint32_t now = cycle_counter_get();
+
+  taskENTER_CRITICAL();
+  {
+    if (!cpu_load.started) {
+      cpu_load.window_start = now;
+      cpu_load.loop = UINT32_MAX;
+      cpu_load.started = true;
+    } else {
+      uint32_t gap = now - cpu_load.last_call;
+      if (gap < cpu_load.loop)
+        cpu_load.loop = gap;
+      // Preempted meanwhile, only the loop itself was idle.
+      cpu_load.idle += gap < CPU_LOAD_CONFIG_GAP_CYCLES ? gap : cpu_load.loop;
+      cpu_load_window_(now);
+    }
+    cpu_load.last_call = now;
+  }
+  taskEXIT_CRITICAL();
+#endif
+}
+
+void cpu_load_get(cpu_load_t *load) {
+  if (load == NULL)
+    return;
+#if 1 == CPU_LOAD_CONFIG_ENABLE
+  taskENTER_CRITICAL();
+  {
+    if (cpu_load.started)
+      cpu_load_window_(cycle_counter_get());
+    *load = cpu_load.load;
+  }
+  taskEXIT_CRITICAL();
+#else
+  memset(load, 0, sizeof(*load));
+#endif
+}
+
+void cpu_load_report(void) {
+#if 1 == CPU_LOAD_CONFIG_ENABLE
+  cpu_load_t load;
+  cpu_load_get(&load);
+  taskENTER_CRITICAL();
+  cpu_load.load.peak = 0;
+  taskEXIT_CRITICAL();
+
+  LOGGER_INFO("CPU load: last %u.%u%% avg %u.%u%% peak %u.%u%%",
+              load.last / 10U, load.last % 10U, load.avg / 10U,
+              load.avg % 10U, load.peak / 10U, load.peak % 10U);
+#endif
+}
@@ -0,0 +1,112 @@
+/*
+ * heap_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "heap_bench.h"
+#include "ao_api.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "heap_monitor.h"
+#include "logger.h"
+#include "main.h"
+
+/*< Approximate sizes of the kernel objects of an AO */
+#define HEAP_BENCH_QUEUE_SIZE_ (80U + AO_MAX_QUEUE_MSG * AO_EV_SIZE)
+#define HEAP_BENCH_TCB_SIZE_ (100U)
+#define HEAP_BENCH_STACK_SIZE_ (AO_TASK_STACK_SIZE * sizeof(StackType_t))
+
+#if 1 == HEAP_BENCH_CONFIG_ENABLE
+
+typedef struct {
+  uint32_t max;
+  uint32_t sum;
+  uint32_t count;
+} heap_bench_stat_t;
+
+/* Small blocks dominate, kernel objects come and go with the UI */
+static const size_t heap_bench_sizes_[] = {
+    sizeof(ao_msg_t),
+    sizeof(ao_msg_t),
+    sizeof(ao_msg_t),
+    sizeof(ao_msg_t),
+    sizeof(ao_msg_t),
+    HEAP_BENCH_QUEUE_SIZE_,
+    HEAP_BENCH_TCB_SIZE_,
+    HEAP_BENCH_STACK_SIZE_,
+};
+
+static void *heap_bench_slot_[HEAP_BENCH_CONFIG_SLOTS];
+
+static uint32_t heap_bench_rand_(uint32_t *seed) {
+  *seed = *seed * 1664525U + 1013904223U;
+  return *seed >> 8;
+}
+
+static void heap_bench_add_(heap_bench_stat_t *stat, uint32_t cycles) {
+  if (cycles > stat->max)
+    stat->max = cycles;
+  stat->sum += cycles;
+  stat->count++;
+}
+
+static uint32_t heap_bench_avg_(const heap_bench_stat_t *stat) {
+  return stat->count == 0 ? 0 : stat->sum / stat->count;
+}
+
+static const char *heap_bench_scheme_(void) {
+#if (configHEAP_SCHEME == configHEAP_SCHEME_TLSF)
+  return "tlsf";
+#elif (configHEAP_SCHEME == configHEAP_SCHEME_HEAP_5)
+  return "heap_5";
+#else
+  return "heap_4";
+#endif
+}
+
+#endif
+
+void heap_bench_run(void) {
+#if 1 == HEAP_BENCH_CONFIG_ENABLE
+  heap_bench_stat_t malloc_stat = {0}, free_stat = {0};
+  uint32_t fails = 0, seed = 1;
+  const uint32_t sizes_count =
+      sizeof(heap_bench_sizes_) / sizeof(heap_bench_sizes_[0]);
+
+  // Time the heap alone, not the monitor hooks.
+  heap_monitor_pause(true);
+
+  for (uint32_t i = 0; i < HEAP_BENCH_CONFIG_ROUNDS; i++) {
+    uint32_t s = heap_bench_rand_(&seed) % HEAP_BENCH_CONFIG_SLOTS;
+    uint32_t start;
+
+    if (heap_bench_slot_[s] != NULL) {
+      start = cycle_counter_get();
+      vPortFree(heap_bench_slot_[s]);
+      heap_bench_add_(&free_stat, cycle_counter_get() - start);
+      heap_bench_slot_[s] = NULL;
+    } else {
+      size_t size = heap_bench_sizes_[heap_bench_rand_(&seed) % sizes_count];
+      start = cycle_counter_get();
+      heap_bench_slot_[s] = pvPortMalloc(size);
+      heap_bench_add_(&malloc_stat, cycle_counter_get() - start);
+      if (heap_bench_slot_[s] == NULL)
+        fails++;
+    }
+  }
+
+  for (uint32_t s = 0; s < HEAP_BENCH_CONFIG_SLOTS; s++) {
+    vPortFree(heap_bench_slot_[s]);
+    heap_bench_slot_[s] = NULL;
+  }
+  heap_monitor_pause(false);
+
+  LOGGER_INFO("Heap bench %s (cycles), fails %lu", heap_bench_scheme_(),
+              (unsigned long)fails);
+  LOGGER_INFO("  malloc max %lu avg %lu", (unsigned long)malloc_stat.max,
+              (unsigned long)heap_bench_avg_(&malloc_stat));
+  LOGGER_INFO("  free   max %lu avg %lu", (unsigned long)free_stat.max,
+              (unsigned long)heap_bench_avg_(&free_stat));
+#endif
+}
@@ -0,0 +1,165 @@
+/*
+ * heap_monitor.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "heap_monitor.h"
+#include "cmsis_os.h"
+#include "logger.h"
+#include "main.h"
+
+typedef struct {
+  void *addr;
+  void *caller;
+  uint16_t size;
+} heap_monitor_live_t;
+
+static struct {
+  heap_monitor_record_t ring[HEAP_MONITOR_CONFIG_RING_SIZE];
+  uint16_t ring_head;  /*< Next record to write */
+  uint16_t ring_count; /*< Valid records */
+  heap_monitor_live_t live[HEAP_MONITOR_CONFIG_MAX_LIVE];
+  uint16_t live_count;
+  uint16_t live_lost; /*< Blocks not followed because the table was full */
+  uint32_t fails;
+  bool paused; /*< Hooks ignore the heap */
+} heap_monitor;
+
+/**
+ * @brief Append a record to the trace ring, overwriting the oldest.
+ */
+static void heap_monitor_record(heap_monitor_op_t op, void *addr, size_t size,
+                                void *caller) {
+  heap_monitor_record_t *r = &heap_monitor.ring[heap_monitor.ring_head];
+  r->timestamp = DWT->CYCCNT;
+  r->addr = addr;
+  r->caller = caller;
+  r->size = (uint16_t)size;
+  r->op = (uint8_t)op;
+  heap_monitor.ring_head =
+      (uint16_t)((heap_monitor.ring_head + 1U) % HEAP_MONITOR_CONFIG_RING_SIZE);
+  if (heap_monitor.ring_count < HEAP_MONITOR_CONFIG_RING_SIZE)
+    heap_monitor.ring_count++;
+}
+
+void heap_monitor_on_malloc(void *addr, size_t size, void *caller) {
+#if 1 == HEAP_MONITOR_CONFIG_ENABLE
+  if (heap_monitor.paused)
+    return;
+  if (addr == NULL) {
+    heap_monitor.fails++;
+    heap_monitor_record(HEAP_MONITOR_OP_FAIL, addr, size, caller);
+    return;
+  }
+  heap_monitor_record(HEAP_MONITOR_OP_MALLOC, addr, size, caller);
+
+  for (uint16_t i = 0; i < HEAP_MONITOR_CONFIG_MAX_LIVE; i++) {
+    heap_monitor_live_t *l = &heap_monitor.live[i];
+    if (l->addr == NULL) {
+      l->addr = addr;
+      l->caller = caller;
+      l->size = (uint16_t)size;
+      heap_monitor.live_count++;
+      return;
+    }
+  }
+  heap_monitor.live_lost++;
+#endif
+}
+
+void heap_monitor_on_free(void *addr, size_t size, void *caller) {
+#if 1 == HEAP_MONITOR_CONFIG_ENABLE
+  if (heap_monitor.paused)
+    return;
+  heap_monitor_record(HEAP_MONITOR_OP_FREE, addr, size, caller);
+
+  for (uint16_t i = 0; i < HEAP_MONITOR_CONFIG_MAX_LIVE; i++) {
+    heap_monitor_live_t *l = &heap_monitor.live[i];
+    if (l->addr == addr) {
+      l->addr = NULL;
+      heap_monitor.live_count--;
+      return;
+    }
+  }
+  // Allocated while the live table was full.
+  if (heap_monitor.live_lost > 0)
+    heap_monitor.live_lost--;
+#endif
+}
+
+void heap_monitor_pause(bool pause) {
+#if 1 == HEAP_MONITOR_CONFIG_ENABLE
+  heap_monitor.paused = pause;
+#endif
+}
+
+void heap_monitor_get_metrics(heap_monitor_metrics_t *metrics) {
+  if (metrics == NULL)
+    return;
+
+  HeapStats_t stats;
+  vPortGetHeapStats(&stats);
+
+  metrics->free_bytes = stats.xAvailableHeapSpaceInBytes;
+  metrics->min_free_bytes = stats.xMinimumEverFreeBytesRemaining;
+  metrics->largest_free_block = stats.xSizeOfLargestFreeBlockInBytes;
+  metrics->free_blocks = stats.xNumberOfFreeBlocks;
+  metrics->allocs = (uint32_t)stats.xNumberOfSuccessfulAllocations;
+  metrics->frees = (uint32_t)stats.xNumberOfSuccessfulFrees;
+  metrics->fails = heap_monitor.fails;
+  metrics->live_blocks =
+      (uint16_t)(heap_monitor.live_count + heap_monitor.live_lost);
+  // Share of the free memory that can not be taken in a single allocation.
+  metrics->fragmentation =
+      (stats.xAvailableHeapSpaceInBytes == 0)
+          ? 0
+          : (uint8_t)(100U - (100U * stats.xSizeOfLargestFreeBlockInBytes) /
+                                 stats.xAvailableHeapSpaceInBytes);
+}
+
+uint16_t heap_monitor_get_records(heap_monitor_record_t *records,
+                                  uint16_t max) {
+  if (records == NULL)
+    return 0;
+
+  uint16_t count;
+  vTaskSuspendAll();
+  {
+    count = heap_monitor.ring_count < max ? heap_monitor.ring_count : max;
+    // Skip the oldest records that do not fit.
+    uint16_t first = (uint16_t)((heap_monitor.ring_head +
+                                 HEAP_MONITOR_CONFIG_RING_SIZE - count) %
+                                HEAP_MONITOR_CONFIG_RING_SIZE);
+    for (uint16_t i = 0; i < count; i++)
+      records[i] =
+          heap_monitor.ring[(first + i) % HEAP_MONITOR_CONFIG_RING_SIZE];
+  }
+  xTaskResumeAll();
+  return count;
+}
+
+void heap_monitor_report(void) {
+#if 1 == HEAP_MONITOR_CONFIG_ENABLE
+  heap_monitor_metrics_t m;
+  heap_monitor_get_metrics(&m);
+
+  LOGGER_INFO("Heap free %u min %u largest %u", (unsigned)m.free_bytes,
+              (unsigned)m.min_free_bytes, (unsigned)m.largest_free_block);
+  LOGGER_INFO("Heap blocks %u frag %u%% live %u fails %lu",
+              (unsigned)m.free_blocks, m.fragmentation, m.live_blocks,
+              (unsigned long)m.fails);
+
+  for (uint16_t i = 0; i < HEAP_MONITOR_CONFIG_MAX_LIVE; i++) {
+    // One entry at a time, the callers have small stacks.
+    heap_monitor_live_t live;
+    vTaskSuspendAll();
+    live = heap_monitor.live[i];
+    xTaskResumeAll();
+    if (live.addr == NULL)
+      continue;
+    LOGGER_INFO("  live %p size %u caller %p", live.addr, live.size,
+                live.caller);
+  }
+#endif
+}
@@ -0,0 +1,45 @@
+/*
+ * heap_regions.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "heap_regions.h"
+#include "cmsis_os.h"
+#include "linker_sections.h"
+#include "logger.h"
+
+/*< Regions of the heap, defined in the linker script */
+extern uint8_t _sheap_ccm, _eheap_ccm;
+extern uint8_t _sheap_sram, _eheap_sram;
+
+void heap_regions_init(void) {
+#if (configHEAP_SCHEME == configHEAP_SCHEME_HEAP_5)
+  // Filled at run time, the linker symbols are not constant expressions.
+  HeapRegion_t regions[HEAP_REGION_MAX + 1] = {
+      [HEAP_REGION_CCM] = {&_sheap_ccm, (size_t)(&_eheap_ccm - &_sheap_ccm)},
+      [HEAP_REGION_SRAM] = {&_sheap_sram,
+                            (size_t)(&_eheap_sram - &_sheap_sram)},
+      [HEAP_REGION_MAX] = {NULL, 0},
+  };
+  vPortDefineHeapRegions(regions);
+
+  LOGGER_INFO("Heap CCM %u SRAM %u bytes",
+              (unsigned)regions[HEAP_REGION_CCM].xSizeInBytes,
+              (unsigned)regions[HEAP_REGION_SRAM].xSizeInBytes);
+#endif
+}
+
+void *heap_regions_malloc(size_t size, heap_region_t region) {
+  if (region >= HEAP_REGION_MAX)
+    return NULL;
+
+#if (configHEAP_SCHEME == configHEAP_SCHEME_HEAP_5)
+  return pvPortMallocFromRegion(size, (BaseType_t)region);
+#else
+  // Single region heap, only usable when it is the one asked for.
+  heap_region_t heap_region =
+      LINKER_CONFIG_HEAP_IN_CCM ? HEAP_REGION_CCM : HEAP_REGION_SRAM;
+  return region == heap_region ? pvPortMalloc(size) : NULL;
+#endif
+}
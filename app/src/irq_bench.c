@@ -0,0 +1,246 @@
+/*
+ * irq_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "irq_bench.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "logger.h"
+#include "main.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*< Above every application task, it is the task woken by the interrupt */
+#define IRQ_BENCH_PRIORITY (configMAX_PRIORITIES - 1)
+/*< Tasks yielding to each other, above the application ones */
+#define IRQ_BENCH_SWITCH_PRIORITY (tskIDLE_PRIORITY + 4)
+/*< Load task, below the button task */
+#define IRQ_BENCH_LOAD_PRIORITY (tskIDLE_PRIORITY + 2)
+/*< Bytes copied by each step of the load */
+#define IRQ_BENCH_LOAD_SIZE (256)
+
+#if 1 == IRQ_BENCH_CONFIG_ENABLE
+
+typedef enum {
+  IRQ_BENCH_OFF = 0,
+  IRQ_BENCH_QUEUE,  /*< The hook wakes the bench task by its queue */
+  IRQ_BENCH_NOTIFY, /*< The hook wakes the bench task by a notification */
+} irq_bench_mode_t;
+
+typedef enum {
+  IRQ_BENCH_ENTRY = 0,
+  IRQ_BENCH_WAKE_QUEUE,
+  IRQ_BENCH_WAKE_NOTIFY,
+  IRQ_BENCH_SWITCH,
+  IRQ_BENCH__N,
+} irq_bench_measure_t;
+
+typedef struct {
+  uint32_t min;
+  uint32_t max;
+  uint32_t sum;
+  uint32_t count;
+} irq_bench_stat_t;
+
+static const char *const irq_bench_names_[IRQ_BENCH__N] = {
+    [IRQ_BENCH_ENTRY] = "entry",
+    [IRQ_BENCH_WAKE_QUEUE] = "queue",
+    [IRQ_BENCH_WAKE_NOTIFY] = "notify",
+    [IRQ_BENCH_SWITCH] = "switch",
+};
+
+static struct {
+  volatile uint8_t mode;     /*< irq_bench_mode_t */
+  volatile uint32_t isr_cyc; /*< Cycle counter at the hook */
+  uint32_t cyc_per_count;    /*< CPU cycles per TIM2 count */
+  irq_bench_stat_t entry;    /*< Written by the hook only */
+  QueueHandle_t queue;
+  TaskHandle_t task;
+  volatile uint32_t stamp; /*< Cycle counter when yielding */
+  volatile bool yielded;   /*< A yield to time */
+  irq_bench_stat_t *switch_stat;
+  irq_bench_stat_t result[IRQ_BENCH__N][2]; /*< Idle, then loaded */
+} irq_bench;
+
+static void irq_bench_add_(irq_bench_stat_t *stat, uint32_t cycles) {
+  if (stat->count == 0 || cycles < stat->min)
+    stat->min = cycles;
+  if (cycles > stat->max)
+    stat->max = cycles;
+  stat->sum += cycles;
+  stat->count++;
+}
+
+/**
+ * @brief CPU cycles per count of TIM2, whatever its prescaler.
+ */
+static uint32_t irq_bench_cyc_per_count_(void) {
+  uint32_t tim_hz = HAL_RCC_GetPCLK1Freq();
+  // Timers run at twice a divided APB clock.
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+    tim_hz *= 2U;
+  tim_hz /= (TIM2->PSC + 1U);
+  return SystemCoreClock / tim_hz;
+}
+
+/**
+ * @brief Time the wake up of this task by the TIM2 hook.
+ *
+ * @param mode How the hook wakes this task.
+ * @param stat Where the wake up times are added.
+ */
+static void irq_bench_wake_(irq_bench_mode_t mode, irq_bench_stat_t *stat) {
+  xQueueReset(irq_bench.queue);
+  ulTaskNotifyTake(pdTRUE, 0);
+  irq_bench.mode = mode;
+
+  for (uint32_t i = 0; i < IRQ_BENCH_CONFIG_SAMPLES; i++) {
+    uint32_t isr_cyc;
+    if (mode == IRQ_BENCH_QUEUE) {
+      if (xQueueReceive(irq_bench.queue, &isr_cyc, pdMS_TO_TICKS(100)) !=
+          pdPASS)
+        break;
+    } else {
+      if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)) == 0)
+        break;
+      isr_cyc = irq_bench.isr_cyc;
+    }
+    irq_bench_add_(stat, cycle_counter_get() - isr_cyc);
+  }
+  irq_bench.mode = IRQ_BENCH_OFF;
+}
+
+static void irq_bench_partner_(void *argument) {
+  for (;;) {
+    uint32_t now = cycle_counter_get();
+    if (irq_bench.yielded) {
+      irq_bench_add_(irq_bench.switch_stat, now - irq_bench.stamp);
+      irq_bench.yielded = false;
+    }
+    // Back to the bench task, out of the way of the load meanwhile.
+    vTaskSuspend(NULL);
+  }
+}
+
+/**
+ * @brief Time the switch to a task of the same priority on a yield.
+ *
+ * @param stat Where the switch times are added.
+ */
+static void irq_bench_switch_(irq_bench_stat_t *stat) {
+  TaskHandle_t partner;
+  irq_bench.switch_stat = stat;
+  irq_bench.yielded = false;
+  vTaskPrioritySet(NULL, IRQ_BENCH_SWITCH_PRIORITY);
+  if (xTaskCreate(irq_bench_partner_, "irq_bench_yield",
+                  configMINIMAL_STACK_SIZE, NULL, IRQ_BENCH_SWITCH_PRIORITY,
+                  &partner) != pdPASS) {
+    vTaskPrioritySet(NULL, IRQ_BENCH_PRIORITY);
+    return;
+  }
+
+  for (uint32_t i = 0; i < IRQ_BENCH_CONFIG_SAMPLES; i++) {
+    vTaskResume(partner); // Ready, but same priority, so it does not run yet.
+    irq_bench.yielded = true;
+    irq_bench.stamp = cycle_counter_get();
+    taskYIELD(); // The partner runs, times it and suspends.
+    irq_bench.yielded = false;
+    vTaskDelay(1); // Let lower priority work, the load, run between samples.
+  }
+
+  vTaskDelete(partner);
+  vTaskPrioritySet(NULL, IRQ_BENCH_PRIORITY);
+}
+
+static void irq_bench_load_(void *argument) {
+  static uint8_t src[IRQ_BENCH_LOAD_SIZE], dst[IRQ_BENCH_LOAD_SIZE];
+  for (;;) {
+    // As the kernel and the AO core do, with TIM2 masked meanwhile.
+    taskENTER_CRITICAL();
+    memcpy(dst, src, sizeof(dst));
+    taskEXIT_CRITICAL();
+    memcpy(src, dst, sizeof(src));
+  }
+}
+
+/**
+ * @brief Take every measure under the current load.
+ *
+ * @param result Where the measures are kept.
+ */
+static void irq_bench_run_(irq_bench_stat_t result[IRQ_BENCH__N]) {
+  memset(&irq_bench.entry, 0, sizeof(irq_bench.entry));
+  irq_bench_wake_(IRQ_BENCH_QUEUE, &result[IRQ_BENCH_WAKE_QUEUE]);
+  irq_bench_wake_(IRQ_BENCH_NOTIFY, &result[IRQ_BENCH_WAKE_NOTIFY]);
+  // Entries of both, the hook is off now.
+  result[IRQ_BENCH_ENTRY] = irq_bench.entry;
+  irq_bench_switch_(&result[IRQ_BENCH_SWITCH]);
+}
+
+static uint32_t irq_bench_avg_(const irq_bench_stat_t *stat) {
+  return stat->count ? stat->sum / stat->count : 0;
+}
+
+static void irq_bench_task_(void *argument) {
+  TaskHandle_t load;
+
+  irq_bench_run_(irq_bench.result[0]);
+  if (xTaskCreate(irq_bench_load_, "irq_bench_load", configMINIMAL_STACK_SIZE,
+                  NULL, IRQ_BENCH_LOAD_PRIORITY, &load) == pdPASS) {
+    irq_bench_run_(irq_bench.result[1]);
+    vTaskDelete(load);
+  }
+
+  LOGGER_INFO("IRQ bench (cycles at %lu MHz)",
+              (unsigned long)(SystemCoreClock / 1000000U));
+  LOGGER_INFO("          ------ idle ------ | ----- loaded -----");
+  LOGGER_INFO("  measure   min   avg    max |   min   avg    max");
+  for (uint8_t m = 0; m < IRQ_BENCH__N; m++) {
+    const irq_bench_stat_t *idle = &irq_bench.result[m][0];
+    const irq_bench_stat_t *loaded = &irq_bench.result[m][1];
+    LOGGER_INFO("  %-7s %5lu %5lu %6lu | %5lu %5lu %6lu", irq_bench_names_[m],
+                (unsigned long)idle->min, (unsigned long)irq_bench_avg_(idle),
+                (unsigned long)idle->max, (unsigned long)loaded->min,
+                (unsigned long)irq_bench_avg_(loaded),
+                (unsigned long)loaded->max);
+  }
+
+  vQueueDelete(irq_bench.queue);
+  irq_bench.queue = NULL;
+  vTaskDelete(NULL);
+}
+
+#endif
+
+void irq_bench_start(void) {
+#if 1 == IRQ_BENCH_CONFIG_ENABLE
+  irq_bench.cyc_per_count = irq_bench_cyc_per_count_();
+  irq_bench.queue = xQueueCreate(1, sizeof(uint32_t));
+  if (irq_bench.queue == NULL)
+    return;
+  xTaskCreate(irq_bench_task_, "irq_bench", configMINIMAL_STACK_SIZE, NULL,
+              IRQ_BENCH_PRIORITY, &irq_bench.task);
+#endif
+}
+
+void irq_bench_isr(void) {
+#if 1 == IRQ_BENCH_CONFIG_ENABLE
+  uint32_t count = TIM2->CNT;
+  uint32_t now = cycle_counter_get();
+  uint8_t mode = irq_bench.mode;
+  // The counter restarts at the update event, only those are timed.
+  if (mode == IRQ_BENCH_OFF || !(TIM2->SR & TIM_SR_UIF))
+    return;
+
+  irq_bench_add_(&irq_bench.entry, count * irq_bench.cyc_per_count);
+  irq_bench.isr_cyc = now;
+  BaseType_t woken = pdFALSE;
+  if (mode == IRQ_BENCH_QUEUE)
+    xQueueSendFromISR(irq_bench.queue, &now, &woken);
+  else
+    vTaskNotifyGiveFromISR(irq_bench.task, &woken);
+  portYIELD_FROM_ISR(woken);
+#endif
+}
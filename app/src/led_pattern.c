@@ -0,0 +1,175 @@
+/*
+ * led_pattern.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "led_pattern.h"
+#include "board.h"
+#include "led_pattern_port.h"
+#include "linker_sections.h"
+#include <stddef.h>
+
+typedef struct {
+  led_pattern_id_t id;
+  GPIO_TypeDef *port;
+  uint16_t pins;
+} led_pattern_sys_t;
+
+/*< Morse SOS, one step per morse unit */
+static const uint8_t led_pattern_sos_steps[] = {
+    1, 0, 1, 0, 1, 0, 0, 0,                         // S
+    1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 0, 0,       // O
+    1, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,       // S + word gap
+};
+
+/*< Half breathe cycle, gamma corrected. Played forward and backward */
+static const uint8_t led_pattern_breathe_steps[] = {
+    0,   1,   2,   4,   7,   10,  14,  19,  25,  32,  39,
+    47,  56,  66,  77,  88,  100, 113, 127, 141, 156, 172,
+    188, 205, 223, 241, 255,
+};
+
+static const uint8_t led_pattern_blink_steps[] = {1, 0};
+
+static const led_pattern_t led_patterns[LED_PATTERN__N] = {
+    [LED_PATTERN_BLINK] = {.kind = LED_PATTERN_KIND_ONOFF,
+                           .step_ms = 500,
+                           .mirror = false,
+                           .steps_count = sizeof(led_pattern_blink_steps),
+                           .steps = led_pattern_blink_steps},
+    [LED_PATTERN_SOS] = {.kind = LED_PATTERN_KIND_ONOFF,
+                         .step_ms = 150,
+                         .mirror = false,
+                         .steps_count = sizeof(led_pattern_sos_steps),
+                         .steps = led_pattern_sos_steps},
+    [LED_PATTERN_BREATHE] = {.kind = LED_PATTERN_KIND_PWM,
+                             .step_ms = 40,
+                             .mirror = true,
+                             .steps_count = sizeof(led_pattern_breathe_steps),
+                             .steps = led_pattern_breathe_steps},
+};
+
+/*< Words written by DMA. Keep it in SRAM: DMA can not reach CCM RAM */
+static uint32_t led_pattern_buffer[LED_PATTERN_MAX_STEPS] LINKER_SECTION_DMA;
+
+static led_pattern_sys_t led_pattern_sys;
+
+/**
+ * @brief Get the step of a pattern in the played order.
+ *
+ * @param pattern Pattern descriptor.
+ * @param i Step position.
+ * @return uint8_t Step value.
+ */
+static uint8_t led_pattern_step(const led_pattern_t *pattern, uint16_t i) {
+  if (i < pattern->steps_count)
+    return pattern->steps[i];
+  // Mirrored half, without repeating both ends.
+  return pattern->steps[2 * pattern->steps_count - 2 - i];
+}
+
+/**
+ * @brief Compile a pattern into the words written by the DMA.
+ *
+ * @note The words are rotated by one, the first step is written by the CPU
+ * when the pattern starts and the DMA writes the next one on every step.
+ *
+ * @param pattern Pattern descriptor.
+ * @param pins Pins for on/off patterns.
+ * @param pwm_period PWM period for PWM patterns.
+ * @param first Where the first word is returned.
+ * @return uint16_t Number of compiled words, 0 if it does not fit.
+ */
+static uint16_t led_pattern_compile(const led_pattern_t *pattern, uint16_t pins,
+                                    uint32_t pwm_period, uint32_t *first) {
+  uint16_t count = pattern->steps_count;
+  if (pattern->mirror && count > 2)
+    count = 2 * count - 2;
+  if (count == 0 || count > LED_PATTERN_MAX_STEPS)
+    return 0;
+
+  uint32_t on = (LED_ON == GPIO_PIN_SET) ? pins : ((uint32_t)pins << 16U);
+  uint32_t off = (LED_ON == GPIO_PIN_SET) ? ((uint32_t)pins << 16U) : pins;
+
+  for (uint16_t i = 0; i < count; i++) {
+    uint8_t step = led_pattern_step(pattern, i);
+    uint32_t word;
+    if (pattern->kind == LED_PATTERN_KIND_PWM)
+      word = (pwm_period * step) / 255U;
+    else
+      word = step ? on : off;
+
+    if (i == 0)
+      *first = word;
+    led_pattern_buffer[(i + count - 1) % count] = word;
+  }
+  return count;
+}
+
+void led_pattern_init(void) {
+  led_pattern_sys.id = LED_PATTERN_NONE;
+  led_pattern_sys.port = NULL;
+  led_pattern_sys.pins = 0;
+  led_pattern_port_init();
+}
+
+const led_pattern_t *led_pattern_get(led_pattern_id_t id) {
+  if (id <= LED_PATTERN_NONE || id >= LED_PATTERN__N)
+    return NULL;
+  return &led_patterns[id];
+}
+
+int led_pattern_play(led_pattern_id_t id, GPIO_TypeDef *port, uint16_t pins) {
+  led_pattern_stop();
+  if (id == LED_PATTERN_NONE)
+    return 0;
+
+  const led_pattern_t *pattern = led_pattern_get(id);
+  if (pattern == NULL || port == NULL || pins == 0)
+    return -1;
+
+  volatile uint32_t *dst = &port->BSRR;
+  uint32_t pwm_period = 0;
+  if (pattern->kind == LED_PATTERN_KIND_PWM) {
+    dst = led_pattern_port_pwm_attach(port, pins);
+    if (dst == NULL)
+      return -1;
+    pwm_period = led_pattern_port_pwm_period();
+  }
+
+  uint32_t first = 0;
+  uint16_t count = led_pattern_compile(pattern, pins, pwm_period, &first);
+  if (count == 0) {
+    if (pattern->kind == LED_PATTERN_KIND_PWM)
+      led_pattern_port_pwm_detach();
+    return -1;
+  }
+
+  led_pattern_sys.id = id;
+  led_pattern_sys.port = port;
+  led_pattern_sys.pins = pins;
+
+  *dst = first;
+  led_pattern_port_start(dst, led_pattern_buffer, count, pattern->step_ms);
+  return 0;
+}
+
+void led_pattern_stop(void) {
+  if (led_pattern_sys.id == LED_PATTERN_NONE)
+    return;
+
+  led_pattern_port_stop();
+  if (led_patterns[led_pattern_sys.id].kind == LED_PATTERN_KIND_PWM)
+    led_pattern_port_pwm_detach();
+
+  led_pattern_sys.id = LED_PATTERN_NONE;
+  led_pattern_sys.port = NULL;
+  led_pattern_sys.pins = 0;
+}
+
+uint16_t led_pattern_pins(GPIO_TypeDef *port) {
+  if (led_pattern_sys.id == LED_PATTERN_NONE || led_pattern_sys.port != port)
+    return 0;
+  return led_pattern_sys.pins;
+}
@@ -0,0 +1,144 @@
+/*
+ * led_pattern_port.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "led_pattern_port.h"
+#include "board.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * TIM8 update events pace the steps. Each update triggers DMA2 Stream1
+ * Channel7 (TIM8_UP), which writes the next word into the target register
+ * (GPIO BSRR or a PWM compare register) in circular mode.
+ */
+
+/*< Step timer tick frequency */
+#define LED_PATTERN_PORT_TICK_HZ (10000U)
+/*< DMA request channel of TIM8_UP in DMA2 Stream1 */
+#define LED_PATTERN_PORT_DMA_CHANNEL (7U)
+/*< PWM counter frequency */
+#define LED_PATTERN_PORT_PWM_CLOCK_HZ (1000000U)
+/*< PWM frequency, high enough to avoid flicker */
+#define LED_PATTERN_PORT_PWM_HZ (1000U)
+
+#define LED_PATTERN_PORT_TIM (TIM8)
+#define LED_PATTERN_PORT_DMA (DMA2_Stream1)
+#define LED_PATTERN_PORT_DMA_FLAGS                                             \
+  (DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 |                    \
+   DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1)
+
+/**
+ * @brief Get the clock of a timer on the APB1 or APB2 bus.
+ *
+ * @param apb2 True if the timer is on APB2.
+ * @return uint32_t Timer clock in Hz.
+ */
+static uint32_t led_pattern_port_tim_clock(bool apb2) {
+  uint32_t pclk = apb2 ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+  uint32_t ppre = RCC->CFGR & (apb2 ? RCC_CFGR_PPRE2 : RCC_CFGR_PPRE1);
+  // Timers run at twice the bus clock when the bus is prescaled.
+  return (ppre == 0) ? pclk : 2U * pclk;
+}
+
+void led_pattern_port_init(void) {
+  __HAL_RCC_DMA2_CLK_ENABLE();
+  __HAL_RCC_TIM8_CLK_ENABLE();
+
+  LED_PATTERN_PORT_TIM->CR1 = 0;
+  LED_PATTERN_PORT_TIM->PSC =
+      (led_pattern_port_tim_clock(true) / LED_PATTERN_PORT_TICK_HZ) - 1U;
+  LED_PATTERN_PORT_TIM->EGR = TIM_EGR_UG; // Load prescaler.
+  LED_PATTERN_PORT_TIM->SR = 0;
+
+#if defined(LED_A_PWM_TIM)
+  __HAL_RCC_TIM3_CLK_ENABLE();
+  LED_A_PWM_TIM->CR1 = 0;
+  LED_A_PWM_TIM->PSC =
+      (led_pattern_port_tim_clock(false) / LED_PATTERN_PORT_PWM_CLOCK_HZ) - 1U;
+  LED_A_PWM_TIM->ARR =
+      (LED_PATTERN_PORT_PWM_CLOCK_HZ / LED_PATTERN_PORT_PWM_HZ) - 1U;
+  LED_A_PWM_TIM->LED_A_PWM_CCR = 0;
+  // PWM mode 1 with preload, active high (mode 2 for active low leds).
+  LED_A_PWM_TIM->CCMR2 =
+      ((LED_ON == GPIO_PIN_SET ? 6U : 7U) << TIM_CCMR2_OC3M_Pos) |
+      TIM_CCMR2_OC3PE;
+  LED_A_PWM_TIM->CCER = TIM_CCER_CC3E;
+  LED_A_PWM_TIM->EGR = TIM_EGR_UG;
+  LED_A_PWM_TIM->CR1 = TIM_CR1_ARPE | TIM_CR1_CEN;
+#endif
+}
+
+void led_pattern_port_start(volatile uint32_t *dst, const uint32_t *src,
+                            uint16_t count, uint16_t step_ms) {
+  led_pattern_port_stop();
+
+  LED_PATTERN_PORT_DMA->PAR = (uint32_t)dst;
+  LED_PATTERN_PORT_DMA->M0AR = (uint32_t)src;
+  LED_PATTERN_PORT_DMA->NDTR = count;
+  LED_PATTERN_PORT_DMA->FCR = 0; // Direct mode.
+  LED_PATTERN_PORT_DMA->CR =
+      (LED_PATTERN_PORT_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) |
+      DMA_SxCR_MSIZE_1 | DMA_SxCR_PSIZE_1 | DMA_SxCR_MINC | DMA_SxCR_CIRC |
+      DMA_SxCR_DIR_0;
+  LED_PATTERN_PORT_DMA->CR |= DMA_SxCR_EN;
+
+  uint32_t ticks = ((uint32_t)step_ms * LED_PATTERN_PORT_TICK_HZ) / 1000U;
+  LED_PATTERN_PORT_TIM->ARR = (ticks > 0 ? ticks : 1U) - 1U;
+  LED_PATTERN_PORT_TIM->CNT = 0;
+  LED_PATTERN_PORT_TIM->DIER = TIM_DIER_UDE;
+  LED_PATTERN_PORT_TIM->CR1 = TIM_CR1_CEN;
+}
+
+void led_pattern_port_stop(void) {
+  LED_PATTERN_PORT_TIM->CR1 = 0;
+  LED_PATTERN_PORT_TIM->DIER = 0;
+
+  LED_PATTERN_PORT_DMA->CR &= ~DMA_SxCR_EN;
+  while (LED_PATTERN_PORT_DMA->CR & DMA_SxCR_EN) {
+    // Wait for the on-going transfer to finish.
+  }
+  DMA2->LIFCR = LED_PATTERN_PORT_DMA_FLAGS;
+}
+
+volatile uint32_t *led_pattern_port_pwm_attach(GPIO_TypeDef *port,
+                                               uint16_t pin) {
+#if defined(LED_A_PWM_TIM)
+  if (port != LED_A_PORT || pin != LED_A_PIN)
+    return NULL;
+
+  GPIO_InitTypeDef gpio = {0};
+  gpio.Pin = LED_A_PIN;
+  gpio.Mode = GPIO_MODE_AF_PP;
+  gpio.Pull = GPIO_NOPULL;
+  gpio.Speed = GPIO_SPEED_FREQ_LOW;
+  gpio.Alternate = LED_A_PWM_AF;
+  HAL_GPIO_Init(LED_A_PORT, &gpio);
+  return &LED_A_PWM_TIM->LED_A_PWM_CCR;
+#else
+  return NULL;
+#endif
+}
+
+void led_pattern_port_pwm_detach(void) {
+#if defined(LED_A_PWM_TIM)
+  LED_A_PWM_TIM->LED_A_PWM_CCR = 0;
+
+  GPIO_InitTypeDef gpio = {0};
+  gpio.Pin = LED_A_PIN;
+  gpio.Mode = GPIO_MODE_OUTPUT_PP;
+  gpio.Pull = GPIO_NOPULL;
+  gpio.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(LED_A_PORT, &gpio);
+#endif
+}
+
+uint32_t led_pattern_port_pwm_period(void) {
+#if defined(LED_A_PWM_TIM)
+  return LED_A_PWM_TIM->ARR + 1U;
+#else
+  return 0;
+#endif
+}
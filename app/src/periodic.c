@@ -0,0 +1,85 @@
+/*
+ * periodic.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "periodic.h"
+#include "dwt.h"
+#include "logger.h"
+#include "main.h"
+#include <stddef.h>
+
+void periodic_init(periodic_t *p, uint32_t period_ms) {
+  if (p == NULL)
+    return;
+
+  p->period = pdMS_TO_TICKS(period_ms);
+  if (p->period == 0)
+    p->period = 1;
+  p->cyc_per_tick = SystemCoreClock / configTICK_RATE_HZ;
+  // Anchor the cycle counter on a tick edge, as every release will be.
+  p->last_wake = xTaskGetTickCount();
+  vTaskDelayUntil(&p->last_wake, 1);
+  p->anchor_tick = p->last_wake;
+  p->anchor_cyc = cycle_counter_get();
+  p->release_cyc = p->anchor_cyc;
+  p->stats = (periodic_stats_t){.activations = 1};
+}
+
+void periodic_wait(periodic_t *p) {
+  if (p == NULL)
+    return;
+
+  uint32_t response = cycle_counter_get() - p->release_cyc;
+  p->stats.response_last = response;
+  if (response > p->stats.response_max)
+    p->stats.response_max = response;
+
+  TickType_t elapsed = xTaskGetTickCount() - p->last_wake;
+  if (elapsed > p->period) {
+    // Skip the releases already missed, the next one is still in phase.
+    TickType_t missed = (elapsed - 1) / p->period;
+    p->last_wake += missed * p->period;
+    p->stats.overruns++;
+    p->stats.skipped += missed;
+  }
+  vTaskDelayUntil(&p->last_wake, p->period);
+
+  // Cycle counter and tick come from the same clock, they do not drift.
+  uint32_t now = cycle_counter_get();
+  uint32_t ticks = (uint32_t)(p->last_wake - p->anchor_tick);
+  p->release_cyc = p->anchor_cyc + ticks * p->cyc_per_tick;
+  int32_t release = (int32_t)(now - p->release_cyc);
+  if (p->stats.activations == 1 || release < p->stats.release_min)
+    p->stats.release_min = release;
+  if (p->stats.activations == 1 || release > p->stats.release_max)
+    p->stats.release_max = release;
+  p->stats.activations++;
+}
+
+void periodic_get_stats(const periodic_t *p, periodic_stats_t *stats) {
+  if (p == NULL || stats == NULL)
+    return;
+
+  taskENTER_CRITICAL();
+  *stats = p->stats;
+  taskEXIT_CRITICAL();
+}
+
+void periodic_report(const periodic_t *p, const char *name) {
+  periodic_stats_t stats;
+  if (p == NULL || name == NULL)
+    return;
+
+  periodic_get_stats(p, &stats);
+  int32_t cyc_per_us = (int32_t)cycles_per_us;
+  LOGGER_INFO("Periodic %s: runs %lu overruns %lu skipped %lu", name,
+              (unsigned long)stats.activations, (unsigned long)stats.overruns,
+              (unsigned long)stats.skipped);
+  LOGGER_INFO("  release %ld..%ld us response %lu max %lu us",
+              (long)(stats.release_min / cyc_per_us),
+              (long)(stats.release_max / cyc_per_us),
+              (unsigned long)(stats.response_last / cyc_per_us),
+              (unsigned long)(stats.response_max / cyc_per_us));
+}
@@ -0,0 +1,132 @@
+/*
+ * stack_monitor.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "stack_monitor.h"
+#include "logger.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*< Recommended sizes are rounded up to keep the stack 8-byte aligned */
+#define STACK_MONITOR_ALIGN_WORDS (2U)
+
+typedef struct {
+  bool used;
+  TaskHandle_t task; /*< NULL while the task does not exist */
+  char name[configMAX_TASK_NAME_LEN];
+  uint16_t depth;    /*< Stack depth in words */
+  uint16_t min_free; /*< Lowest free words ever seen */
+} stack_monitor_entry_t;
+
+static struct {
+  stack_monitor_entry_t entry[STACK_MONITOR_CONFIG_MAX_TASKS];
+  TickType_t last_sample;
+} stack_monitor;
+
+void stack_monitor_register(TaskHandle_t task, const char *name,
+                            uint16_t depth) {
+#if 1 == STACK_MONITOR_CONFIG_ENABLE
+  if (task == NULL || name == NULL)
+    return;
+
+  stack_monitor_entry_t *free_entry = NULL;
+  stack_monitor_entry_t *entry = NULL;
+  vTaskSuspendAll();
+  {
+    for (uint8_t i = 0; i < STACK_MONITOR_CONFIG_MAX_TASKS; i++) {
+      stack_monitor_entry_t *e = &stack_monitor.entry[i];
+      if (!e->used) {
+        if (free_entry == NULL)
+          free_entry = e;
+      } else if (e->task == NULL &&
+                 strncmp(e->name, name, sizeof(e->name)) == 0) {
+        entry = e; // Same task created again, keep its peak.
+        break;
+      }
+    }
+    if (entry == NULL && free_entry != NULL) {
+      entry = free_entry;
+      entry->used = true;
+      strncpy(entry->name, name, sizeof(entry->name) - 1);
+      entry->name[sizeof(entry->name) - 1] = '\0';
+      entry->min_free = depth;
+    }
+    if (entry != NULL) {
+      entry->task = task;
+      entry->depth = depth;
+    }
+  }
+  xTaskResumeAll();
+#endif
+}
+
+void stack_monitor_unregister(TaskHandle_t task) {
+#if 1 == STACK_MONITOR_CONFIG_ENABLE
+  vTaskSuspendAll();
+  {
+    for (uint8_t i = 0; i < STACK_MONITOR_CONFIG_MAX_TASKS; i++) {
+      stack_monitor_entry_t *e = &stack_monitor.entry[i];
+      if (e->used && e->task == task) {
+        // Last look before the stack is gone.
+        UBaseType_t free_words = uxTaskGetStackHighWaterMark(task);
+        if (free_words < e->min_free)
+          e->min_free = (uint16_t)free_words;
+        e->task = NULL;
+      }
+    }
+  }
+  xTaskResumeAll();
+#endif
+}
+
+void stack_monitor_sample(void) {
+#if 1 == STACK_MONITOR_CONFIG_ENABLE
+  // Tasks can not be deleted while the scheduler is suspended.
+  vTaskSuspendAll();
+  {
+    for (uint8_t i = 0; i < STACK_MONITOR_CONFIG_MAX_TASKS; i++) {
+      stack_monitor_entry_t *e = &stack_monitor.entry[i];
+      if (!e->used || e->task == NULL)
+        continue;
+      UBaseType_t free_words = uxTaskGetStackHighWaterMark(e->task);
+      if (free_words < e->min_free)
+        e->min_free = (uint16_t)free_words;
+    }
+  }
+  xTaskResumeAll();
+#endif
+}
+
+void stack_monitor_idle(void) {
+#if 1 == STACK_MONITOR_CONFIG_ENABLE
+  TickType_t now = xTaskGetTickCount();
+  if ((now - stack_monitor.last_sample) <
+      pdMS_TO_TICKS(STACK_MONITOR_CONFIG_PERIOD_MS))
+    return;
+  stack_monitor.last_sample = now;
+  stack_monitor_sample();
+#endif
+}
+
+void stack_monitor_report(void) {
+#if 1 == STACK_MONITOR_CONFIG_ENABLE
+  stack_monitor_sample();
+
+  LOGGER_INFO("Stack report (words): task depth peak free recommended");
+  for (uint8_t i = 0; i < STACK_MONITOR_CONFIG_MAX_TASKS; i++) {
+    stack_monitor_entry_t e = stack_monitor.entry[i];
+    if (!e.used)
+      continue;
+    uint32_t peak = (uint32_t)(e.depth - e.min_free);
+    uint32_t recommended =
+        (peak * (100U + STACK_MONITOR_CONFIG_MARGIN_PCT) + 99U) / 100U;
+    recommended = (recommended + STACK_MONITOR_ALIGN_WORDS - 1U) &
+                  ~(STACK_MONITOR_ALIGN_WORDS - 1U);
+    LOGGER_INFO("  %-16s %4u %4lu %4u %4lu%s", e.name, e.depth,
+                (unsigned long)peak, e.min_free, (unsigned long)recommended,
+                e.min_free < STACK_MONITOR_CONFIG_LOW_WORDS ? " LOW" : "");
+  }
+#endif
+}
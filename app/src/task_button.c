@@ -45,17 +45,36 @@
 #include "main.h"
 
 #include "ao_api.h"
+#include "ao_state.h"
+#include "button_gesture.h"
+#include "button_scan.h"
+#include "cpu_load.h"
+#include "heap_monitor.h"
+#include "periodic.h"
+#include "stack_monitor.h"
 #include "task_ui.h"
+#include "ui_latency.h"
 
 /********************** macros and definitions *******************************/
 
-#define TASK_PERIOD_MS_ (50)
+/* Buttons are debounced over 4 periods */
+#define TASK_PERIOD_MS_ (10)
 
 #define BUTTON_PERIOD_MS_ (TASK_PERIOD_MS_)
 #define BUTTON_MAX_IDLE_MS_ (10 * 1000)
 #define BUTTON_PULSE_TIMEOUT_ (200)
 #define BUTTON_SHORT_TIMEOUT_ (1000)
 #define BUTTON_LONG_TIMEOUT_ (2000)
+#define BUTTON_REPEAT_DELAY_ (500)
+#define BUTTON_REPEAT_PERIOD_ (250)
+/* The UI has no double click action. Enabling it delays every pulse */
+#define BUTTON_DOUBLE_WINDOW_ (0)
+#define BUTTON_CHORD_WINDOW_ (100)
+
+/* Position of each button inside the scanner */
+#define BUTTON_A_ (0)
+#define BUTTON_B_ (1)
+#define BUTTON_C_ (2)
 
 /********************** internal data declaration ****************************/
 
@@ -63,43 +82,82 @@
 
 /********************** internal data definition *****************************/
 
+static const button_pin_t buttons_[] = {
+    [BUTTON_A_] = {.port = BUTTON_A_PORT, .pin = BUTTON_A_PIN},
+    [BUTTON_B_] = {.port = BUTTON_B_PORT, .pin = BUTTON_B_PIN},
+    [BUTTON_C_] = {.port = BUTTON_C_PORT, .pin = BUTTON_C_PIN},
+};
+
+static const button_gesture_cfg_t button_gesture_cfg_ = {
+    .pulse_ms = BUTTON_PULSE_TIMEOUT_,
+    .short_ms = BUTTON_SHORT_TIMEOUT_,
+    .long_ms = BUTTON_LONG_TIMEOUT_,
+    .repeat_delay_ms = BUTTON_REPEAT_DELAY_,
+    .repeat_ms = BUTTON_REPEAT_PERIOD_,
+    .double_ms = BUTTON_DOUBLE_WINDOW_,
+    .chord_ms = BUTTON_CHORD_WINDOW_,
+};
+
 /********************** external data definition *****************************/
 
 extern ao_t ao_ui;
-extern SemaphoreHandle_t os_sem_h;
 
 /********************** internal functions definition ************************/
 
-typedef enum {
-  BUTTON_TYPE_NONE,
-  BUTTON_TYPE_PULSE,
-  BUTTON_TYPE_SHORT,
-  BUTTON_TYPE_LONG,
-  BUTTON_TYPE__N,
-} button_type_t;
-
 static struct {
-  uint32_t counter;
   uint32_t counter_idle;
+  periodic_t period;
+  button_mask_t settling; /*< Buttons changing in the previous scan */
 } button;
 
-static void button_init_(void) { button.counter = 0; }
-
-static button_type_t button_process_state_(bool value) {
-  button_type_t ret = BUTTON_TYPE_NONE;
-  if (value) {
-    button.counter += BUTTON_PERIOD_MS_;
-  } else {
-    if (BUTTON_LONG_TIMEOUT_ <= button.counter) {
-      ret = BUTTON_TYPE_LONG;
-    } else if (BUTTON_SHORT_TIMEOUT_ <= button.counter) {
-      ret = BUTTON_TYPE_SHORT;
-    } else if (BUTTON_PULSE_TIMEOUT_ <= button.counter) {
-      ret = BUTTON_TYPE_PULSE;
-    }
-    button.counter = 0;
+static void button_init_(void) {
+  button.counter_idle = 0;
+  button_scan_init(buttons_, (uint8_t)(sizeof(buttons_) / sizeof(buttons_[0])));
+  button_gesture_init(&button_gesture_cfg_);
+  periodic_init(&button.period, TASK_PERIOD_MS_);
+}
+
+static ao_ui_message_t button_process_gesture_(const button_gesture_ev_t *ev) {
+  ao_ui_message_t ui_msg = AO_UI_PRESS_NONE;
+
+  // Only button A drives the UI. The rest is reported.
+  switch (ev->type) {
+  case BUTTON_GESTURE_PULSE: {
+    LOGGER_INFO("Button pulse 0x%02X", ev->buttons);
+    if (ev->buttons == BUTTON_MASK(BUTTON_A_))
+      ui_msg = AO_UI_PRESS_PULSE;
+    break;
+  }
+  case BUTTON_GESTURE_SHORT: {
+    LOGGER_INFO("Button short 0x%02X", ev->buttons);
+    if (ev->buttons == BUTTON_MASK(BUTTON_A_))
+      ui_msg = AO_UI_PRESS_SHORT;
+    break;
+  }
+  case BUTTON_GESTURE_LONG: {
+    LOGGER_INFO("Button long 0x%02X", ev->buttons);
+    if (ev->buttons == BUTTON_MASK(BUTTON_A_))
+      ui_msg = AO_UI_PRESS_LONG;
+    break;
+  }
+  case BUTTON_GESTURE_REPEAT: {
+    LOGGER_INFO("Button repeat 0x%02X %u", ev->buttons, ev->repeat);
+    break;
+  }
+  case BUTTON_GESTURE_DOUBLE: {
+    LOGGER_INFO("Button double click 0x%02X", ev->buttons);
+    break;
   }
-  return ret;
+  case BUTTON_GESTURE_CHORD: {
+    LOGGER_INFO("Button chord 0x%02X", ev->buttons);
+    break;
+  }
+  default: {
+    LOGGER_INFO("Button error");
+    break;
+  }
+  }
+  return ui_msg;
 }
 
 /********************** external functions definition ************************/
@@ -109,68 +167,73 @@ void task_button(void *argument) {
 
   while (true) {
 
-    xSemaphoreTake(os_sem_h,
-                   portMAX_DELAY); // Critical section as this task can create
-                                   // and start destruction of resources.
-    {
-      GPIO_PinState button_state;
-      button_state = HAL_GPIO_ReadPin(BUTTON_PORT, BUTTON_PIN);
-
-      button_type_t button_type;
-      button_type = button_process_state_(button_state);
-      ao_ui_message_t ui_msg = AO_UI_PRESS_NONE;
-
-      switch (button_type) {
-      case BUTTON_TYPE_NONE: {
-        button.counter_idle += BUTTON_PERIOD_MS_;
-        if (button.counter_idle >= BUTTON_MAX_IDLE_MS_) {
-          if (ao_ui_get_state() !=
-              AO_UI_IDLE) // Avoid double destruction of UI object.
-          {
-            LOGGER_INFO("Button idle. Starting shutdown to save resources");
-            ui_msg = AO_UI_PRESS_IDLE;
-          }
+#if 1 == UI_LATENCY_CONFIG_SCRIPT
+    // Known presses, so latency runs can be compared.
+    button_scan_inject(true, ui_latency_script(BUTTON_PERIOD_MS_)
+                                 ? BUTTON_MASK(BUTTON_A_)
+                                 : 0);
+#endif
+
+    // Every button is sampled and debounced at once.
+    button_scan_ev_t scan_ev;
+    button_scan_update(&scan_ev);
+    if (scan_ev.settling & (button_mask_t)~button.settling &
+        BUTTON_MASK(BUTTON_A_))
+      ui_latency_mark(UI_LATENCY_EDGE);
+    button.settling = scan_ev.settling;
+
+    button_gesture_ev_t gestures[BUTTON_GESTURE_MAX_EVENTS];
+    uint8_t gestures_count = button_gesture_update(
+        &scan_ev, BUTTON_PERIOD_MS_, gestures, BUTTON_GESTURE_MAX_EVENTS);
+
+    // The UI publishes its state, no lock is needed to read it. This task
+    // runs above the UI one, which can not change it until the next wait.
+    ao_ui_state_t ui_state = ao_ui_get_state();
+    if (gestures_count == 0) {
+      button.counter_idle += BUTTON_PERIOD_MS_;
+      if (button.counter_idle >= BUTTON_MAX_IDLE_MS_) {
+        // Avoid double destruction of UI object.
+        if (ui_state != AO_UI_IDLE && ui_state != AO_UI_STOPPING) {
+          LOGGER_INFO("Button idle. Starting shutdown to save resources");
+          ao_ui_message_t ui_msg = AO_UI_PRESS_IDLE;
+          ao_send_message(ao_ui, NULL, (uint8_t *)&ui_msg, sizeof(ui_msg));
+          // Quiet moment with the whole UI exercised, size stacks from it.
+          stack_monitor_report();
+          periodic_report(&button.period, "task_button");
+          ui_latency_report();
+          cpu_load_report();
         }
-        break;
-      }
-      case BUTTON_TYPE_PULSE: {
-        LOGGER_INFO("Button pulse");
-        ui_msg = AO_UI_PRESS_PULSE;
-        break;
-      }
-      case BUTTON_TYPE_SHORT: {
-        LOGGER_INFO("Button short");
-        ui_msg = AO_UI_PRESS_SHORT;
-        break;
-      }
-      case BUTTON_TYPE_LONG: {
-        LOGGER_INFO("Button long");
-        ui_msg = AO_UI_PRESS_LONG;
-        break;
       }
-      default: {
-        LOGGER_INFO("Button error");
-        break;
+    } else {
+      // We receive a new external event. Re-allocate resources.
+      button.counter_idle = 0;
+      if (ui_state == AO_UI_STOPPING) {
+        // Never post to a dying UI, the press would be lost with it. The
+        // teardown always ends in IDLE, this task blocks until it does.
+        ao_ui_wait_state(AO_UI_IDLE, AO_STATE_WAIT_FOREVER);
+        ui_state = AO_UI_IDLE;
       }
+      if (ui_state == AO_UI_IDLE) {
+        // The previous teardown is complete, anything left is a leak.
+        heap_monitor_report();
+        LOGGER_INFO("Creating OS resources as external event happened");
+        ao_ui = ao_ui_init();
       }
+    }
 
-      if (button_type != BUTTON_TYPE_NONE) {
-        // We receive a new external event. Re-allocate resources.
-        button.counter_idle = 0;
-        if (ao_ui_get_state() == AO_UI_IDLE) {
-          LOGGER_INFO("Creating OS resources as external event happened");
-          ao_ui = ao_ui_init();
-        }
-      }
-
+    for (uint8_t i = 0; i < gestures_count; i++) {
+      ao_ui_message_t ui_msg = button_process_gesture_(&gestures[i]);
       if (ui_msg != AO_UI_PRESS_NONE) {
+        // A long press fires while held, it starts when the hold time ends.
+        if (ui_msg == AO_UI_PRESS_LONG)
+          ui_latency_mark(UI_LATENCY_EDGE);
+        ui_latency_mark(UI_LATENCY_GESTURE);
         ao_send_message(ao_ui, NULL, (uint8_t *)&ui_msg, sizeof(ui_msg));
       }
-
-      xSemaphoreGive(os_sem_h);
     }
 
-    vTaskDelay((TickType_t)(TASK_PERIOD_MS_ / portTICK_PERIOD_MS));
+    // Absolute release, the time the body takes does not add up.
+    periodic_wait(&button.period);
   }
 }
 
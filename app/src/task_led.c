@@ -37,6 +37,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "board.h"
 #include "cmsis_os.h"
@@ -46,13 +47,10 @@
 
 #include "ao_api.h"
 #include "task_led.h"
+#include "ui_latency.h"
 
 /********************** macros and definitions *******************************/
 
-#define QUEUE_LENGTH_ (3)
-#define QUEUE_ITEM_SIZE_ (sizeof(ao_led_message_t))
-#define AO_LED_BLINK_TIME (1000) /*< milliseconds */
-
 /********************** internal data declaration ****************************/
 
 /********************** internal functions declaration ***********************/
@@ -60,42 +58,151 @@
 /********************** internal data definition *****************************/
 
 typedef struct {
-  GPIO_TypeDef *led_port;
-  uint16_t led_pin;
-} ao_led_data_t;
+  GPIO_TypeDef *port; /*< GPIO port */
+  uint16_t pins;      /*< Pins of the group in this port */
+  uint16_t shadow;    /*< Pins of the group currently on in this port */
+} ao_led_group_port_t;
+
+typedef struct {
+  bool used;
+  uint8_t leds_count;
+  uint8_t ports_count;
+  uint8_t pattern_port; /*< Port index animated by a pattern, if any */
+  uint8_t led_port[AO_LED_GROUP_MAX_LEDS]; /*< Port index of each led */
+  uint16_t led_pin[AO_LED_GROUP_MAX_LEDS]; /*< Pin of each led */
+  ao_led_group_port_t ports[AO_LED_GROUP_MAX_PORTS];
+} ao_led_group_t;
+
+static ao_led_group_t ao_led_groups[AO_LED_GROUP_MAX_INSTANCES];
 
 /********************** external data definition *****************************/
 
 /********************** internal functions definition ************************/
 
-static void ao_led_ev_f(ao_msg_t *ao_msg) {
-  ao_led_data_t *ao_data = (ao_led_data_t *)ao_get_data(ao_msg->receiver);
-  ao_led_message_t msg = *((ao_led_message_t *)ao_msg->ao_msg);
+static void ao_led_group_ev_f(ao_msg_t *ao_msg) {
+  ui_latency_mark(UI_LATENCY_LED);
+  ao_led_group_t *group = *(ao_led_group_t **)ao_get_data(ao_msg->receiver);
+  ao_led_group_msg_t msg = *((ao_led_group_msg_t *)ao_msg->ao_msg);
+  uint16_t on[AO_LED_GROUP_MAX_PORTS] = {0};
+  uint16_t animated = 0;
+  uint8_t pattern_port = AO_LED_GROUP_MAX_PORTS;
+
+  // Release the leds animated by a previous pattern. Their output is unknown,
+  // so take the shadow again from the port.
+  if (group->pattern_port < group->ports_count) {
+    ao_led_group_port_t *port = &group->ports[group->pattern_port];
+    led_pattern_stop();
+    uint16_t odr = (uint16_t)port->port->ODR;
+    port->shadow = (LED_ON == GPIO_PIN_SET ? odr : ~odr) & port->pins;
+    group->pattern_port = AO_LED_GROUP_MAX_PORTS;
+  }
 
-  if (AO_LED_MESSAGE_ON == msg) {
-    LOGGER_INFO("Turning on AO led [Port:%p][Pin:%d]", ao_data->led_port,
-                (int)ao_data->led_pin);
-    HAL_GPIO_WritePin((GPIO_TypeDef *)ao_data->led_port,
-                      (uint16_t)ao_data->led_pin, GPIO_PIN_SET);
+  for (uint8_t i = 0; i < group->leds_count; i++) {
+    if ((msg.mask & AO_LED_MASK(i)) == 0)
+      continue;
+    if (msg.pattern != LED_PATTERN_NONE &&
+        (pattern_port == AO_LED_GROUP_MAX_PORTS ||
+         pattern_port == group->led_port[i])) {
+      pattern_port = group->led_port[i];
+      animated |= group->led_pin[i];
+      continue;
+    }
+    on[group->led_port[i]] |= group->led_pin[i];
   }
-  if (AO_LED_MESSAGE_OFF == msg) {
-    LOGGER_INFO("Turning off AO led [Port:%p][Pin:%d]", ao_data->led_port,
-                (int)ao_data->led_pin);
-    HAL_GPIO_WritePin((GPIO_TypeDef *)ao_data->led_port,
-                      (uint16_t)ao_data->led_pin, GPIO_PIN_RESET);
+
+  // From now on the pattern leds are driven by DMA, the AO is not involved.
+  // If the pattern can not be played on them, they are just turned on.
+  if (animated != 0) {
+    if (led_pattern_play((led_pattern_id_t)msg.pattern,
+                         group->ports[pattern_port].port, animated) == 0) {
+      group->pattern_port = pattern_port;
+    } else {
+      on[pattern_port] |= animated;
+      animated = 0;
+    }
   }
 
-  // Free AO message from sender.
-  ao_sender_free_method(ao_msg->sender, ao_msg);
+  LOGGER_INFO("Setting AO led group [Mask:0x%02x][Pattern:%d]",
+              (unsigned int)msg.mask, (int)msg.pattern);
+  for (uint8_t p = 0; p < group->ports_count; p++) {
+    ao_led_group_port_t *port = &group->ports[p];
+    // Pins handed to the pattern engine are not written here.
+    uint16_t owned = (p == pattern_port) ? (uint16_t)~animated : 0xFFFFU;
+    uint16_t changed = (on[p] ^ port->shadow) & owned;
+    if (changed == 0)
+      continue; // Skip redundant writes.
+
+    uint16_t set = on[p] & changed;
+    uint16_t reset = (uint16_t)(~on[p]) & changed;
+    if (LED_ON != GPIO_PIN_SET) {
+      uint16_t temp = set;
+      set = reset;
+      reset = temp;
+    }
+    // One atomic store updates every led of the group in this port.
+    port->port->BSRR = (uint32_t)set | ((uint32_t)reset << 16U);
+    ui_latency_mark(UI_LATENCY_GPIO);
+    port->shadow = (port->shadow & ~changed) | (on[p] & changed);
+  }
 }
 
 /********************** external functions definition ************************/
 
-ao_t ao_led_init(GPIO_TypeDef *led_port, uint16_t led_pin) {
-  ao_led_data_t ao_led_data = {.led_pin = led_pin, .led_port = led_port};
-  ao_t ao = ao_init((uint8_t *)&ao_led_data, sizeof(ao_led_data), ao_led_ev_f,
-                    NULL, (AO_OP_NO_QUEUE | AO_OP_NO_TASK));
+ao_t ao_led_group_init(const ao_led_pin_t *leds, uint8_t leds_count) {
+  if (leds == NULL || leds_count == 0 || leds_count > AO_LED_GROUP_MAX_LEDS)
+    return NULL;
+
+  ao_led_group_t *group = NULL;
+  for (uint8_t i = 0; i < AO_LED_GROUP_MAX_INSTANCES; i++) {
+    if (!ao_led_groups[i].used) {
+      group = &ao_led_groups[i];
+      break;
+    }
+  }
+  if (group == NULL)
+    return NULL;
+
+  memset(group, 0, sizeof(*group));
+  for (uint8_t i = 0; i < leds_count; i++) {
+    uint8_t p = 0;
+    while (p < group->ports_count && group->ports[p].port != leds[i].led_port)
+      p++;
+    if (p == group->ports_count) {
+      if (p == AO_LED_GROUP_MAX_PORTS)
+        return NULL;
+      group->ports[p].port = leds[i].led_port;
+      group->ports_count++;
+    }
+    group->ports[p].pins |= leds[i].led_pin;
+    group->led_port[i] = p;
+    group->led_pin[i] = leds[i].led_pin;
+  }
+  group->leds_count = leds_count;
+  group->pattern_port = AO_LED_GROUP_MAX_PORTS;
+
+  // Start the shadow from the current output state.
+  for (uint8_t p = 0; p < group->ports_count; p++) {
+    ao_led_group_port_t *port = &group->ports[p];
+    uint16_t odr = (uint16_t)port->port->ODR;
+    port->shadow = (LED_ON == GPIO_PIN_SET ? odr : ~odr) & port->pins;
+  }
+
+  ao_t ao = ao_init(
+      (uint8_t *)&group, sizeof(group), ao_led_group_ev_f, NULL,
+      (AO_OP_NO_QUEUE | AO_OP_NO_TASK | AO_OP_COALESCE | AO_OP_SYNC), NULL);
+  if (ao != NULL)
+    group->used = true;
   return ao;
 }
 
+void ao_led_group_deinit(ao_t ao) {
+  if (ao == NULL)
+    return;
+  ao_led_group_t *group = *(ao_led_group_t **)ao_get_data(ao);
+  if (group->pattern_port < group->ports_count)
+    led_pattern_stop();
+  group->used = false;
+  ao_deinit(ao);
+}
+
 /********************** end of file ******************************************/
@@ -44,13 +44,37 @@
 #include "logger.h"
 #include "main.h"
 
+#include "ao_journal.h"
+#include "ao_state.h"
 #include "task_led.h"
 #include "task_ui.h"
+#include "trace_recorder.h"
+#include "ui_latency.h"
 
 /********************** macros and definitions *******************************/
 
 #define AO_UI_QUEUE_LENGTH_ (3)
 #define AO_UI_QUEUE_ITEM_SIZE_ (sizeof(ao_ui_message_t))
+/* Button events accepted, a noisy source can not flood the UI */
+#define AO_UI_RATE_PER_S_ (10)
+#define AO_UI_RATE_BURST_ (3)
+#define AO_UI_MAX_PENDING_ (2) /*< Leaves a slot for the UI own events */
+/* Presses come in bursts, give the UI inbox more room */
+#define AO_UI_QUEUE_LEN_ (4)
+/* A press shown later than this is noticed by the user. Events need
+ * AO_EV_STAMP to be timed from their post */
+#if 1 == AO_EV_STAMP
+#define AO_UI_WAIT_BUDGET_US_ (50 * 1000)
+#else
+#define AO_UI_WAIT_BUDGET_US_ (0)
+#endif
+/* Handlers log through the debugger, which takes milliseconds */
+#define AO_UI_RUN_BUDGET_US_ (100 * 1000)
+
+/* Position of each led inside the UI led group */
+#define AO_UI_LED_RED_ (0)
+#define AO_UI_LED_GREEN_ (1)
+#define AO_UI_LED_BLUE_ (2)
 
 /********************** internal data declaration ****************************/
 
@@ -58,92 +82,86 @@
 
 /********************** internal data definition *****************************/
 
-static ao_ui_state_t ao_ui_state = AO_UI_IDLE;
+/* Published for the button task, AO_UI_IDLE until the first init */
+static ao_state_t ao_ui_state;
 
-/********************** external data definition *****************************/
+static const ao_led_pin_t ao_ui_leds[] = {
+    [AO_UI_LED_RED_] = {.led_port = LED_RED_PORT, .led_pin = LED_RED_PIN},
+    [AO_UI_LED_GREEN_] = {.led_port = LED_GREEN_PORT, .led_pin = LED_GREEN_PIN},
+    [AO_UI_LED_BLUE_] = {.led_port = LED_BLUE_PORT, .led_pin = LED_BLUE_PIN},
+};
 
-ao_t ao_led_r;
-ao_t ao_led_b;
-ao_t ao_led_g;
+/********************** external data definition *****************************/
 
-extern SemaphoreHandle_t os_sem_h;
+ao_t ao_led_group;
 
 /********************** internal functions definition ************************/
 
-static void ao_ui_turn_off_previous_led(ao_t ao_ui,
-                                        ao_ui_state_t ao_previous_state) {
-  ao_led_message_t ao_led_msg = AO_LED_MESSAGE_OFF;
-  if (ao_previous_state == AO_UI_LED_RED_ON)
-    ao_send_message(ao_led_r, ao_ui, &ao_led_msg, sizeof(ao_led_msg));
-
-  if (ao_previous_state == AO_UI_LED_GREEN_ON)
-    ao_send_message(ao_led_g, ao_ui, &ao_led_msg, sizeof(ao_led_msg));
-
-  if (ao_previous_state == AO_UI_LED_BLUE_ON)
-    ao_send_message(ao_led_b, ao_ui, &ao_led_msg, sizeof(ao_led_msg));
-}
-
 /********************** external functions definition ************************/
 
 static void ao_ui_ev_f(ao_msg_t *ao_msg) {
+  ui_latency_mark(UI_LATENCY_UI);
   ao_ui_message_t ao_message = *(ao_ui_message_t *)ao_msg->ao_msg;
-  // For this example we will send to turn on the LED
-  ao_led_message_t ao_led_msg = AO_LED_MESSAGE_ON;
-  bool need_turn_off = false, need_destroy = false;
-  ao_ui_state_t ao_ui_previous = ao_ui_state;
-  ao_t ao_led_target = NULL;
+  // Target of the whole led group. Leds out of the mask are turned off.
+  ao_led_group_msg_t ao_led_msg = {.mask = 0, .pattern = LED_PATTERN_NONE};
+  bool need_update = false, need_destroy = false;
 
   // The AO receiver is the same AO for user interface (UI)
   switch (ao_message) {
   case AO_UI_PRESS_PULSE: {
-    if (ao_ui_state != AO_UI_LED_RED_ON) {
-      need_turn_off = true;
-      ao_led_target = ao_led_r;
-      ao_ui_state = AO_UI_LED_RED_ON;
+    if (ao_ui_get_state() != AO_UI_LED_RED_ON) {
+      need_update = true;
+      ao_led_msg.mask = AO_LED_MASK(AO_UI_LED_RED_);
+      ao_state_publish(&ao_ui_state, AO_UI_LED_RED_ON);
     }
     break;
   }
   case AO_UI_PRESS_SHORT: {
-    if (ao_ui_state != AO_UI_LED_GREEN_ON) {
-      need_turn_off = true;
-      ao_led_target = ao_led_g;
-      ao_ui_state = AO_UI_LED_GREEN_ON;
+    if (ao_ui_get_state() != AO_UI_LED_GREEN_ON) {
+      need_update = true;
+      ao_led_msg.mask = AO_LED_MASK(AO_UI_LED_GREEN_);
+      ao_state_publish(&ao_ui_state, AO_UI_LED_GREEN_ON);
     }
     break;
   }
   case AO_UI_PRESS_LONG: {
-    if (ao_ui_state != AO_UI_LED_BLUE_ON) {
-      need_turn_off = true;
-      ao_led_target = ao_led_b;
-      ao_ui_state = AO_UI_LED_BLUE_ON;
+    if (ao_ui_get_state() != AO_UI_LED_BLUE_ON) {
+      need_update = true;
+      ao_led_msg.mask = AO_LED_MASK(AO_UI_LED_BLUE_);
+      ao_state_publish(&ao_ui_state, AO_UI_LED_BLUE_ON);
     }
     break;
   }
   case AO_UI_PRESS_IDLE: {
-    xSemaphoreTake(
-        os_sem_h,
-        portMAX_DELAY); // Critical section. Start resource destruction
-    {
-      LOGGER_INFO("User interface idle. Start destruction");
-      need_turn_off = true;
-      need_destroy = true;
-    }
+    // From now on the button task leaves the UI alone. Start resource
+    // destruction.
+    ao_state_publish(&ao_ui_state, AO_UI_STOPPING);
+    LOGGER_INFO("User interface idle. Start destruction");
+    ao_throttle_stats_t throttle;
+    ao_get_throttle_stats(ao_msg->receiver, &throttle);
+    LOGGER_INFO("UI throttled: rate %lu admission %lu",
+                (unsigned long)throttle.rate_limited,
+                (unsigned long)throttle.not_admitted);
+    ao_deadline_stats_t deadline;
+    ao_get_deadline_stats(ao_msg->receiver, &deadline);
+    LOGGER_INFO("UI deadlines: late %lu overruns %lu",
+                (unsigned long)deadline.late, (unsigned long)deadline.overruns);
+    LOGGER_INFO("UI worst (us): wait %lu run %lu",
+                (unsigned long)(deadline.wait_max / cycles_per_us),
+                (unsigned long)(deadline.run_max / cycles_per_us));
+    need_update = true; // Empty mask turns off every led.
+    need_destroy = true;
     break;
   }
   case AO_UI_PRESS_DESTROY: {
-    ao_deinit(ao_led_r);
-    ao_deinit(ao_led_g);
-    ao_deinit(ao_led_b);
+    ao_led_group_deinit(ao_led_group);
     ao_t ao_ui = ao_msg->receiver;
-    ao_generic_free_message(ao_msg); // The message can be free here because the
-                                     // receiver is the sender (UI).
-    ao_ui_state = AO_UI_IDLE;        // AO is in idle state.
-
-    xSemaphoreGive(os_sem_h); // Finally leave control to task button again as
-                              // we almos finis destroying resources.
-
     LOGGER_INFO("Finish destroying User Interface");
 
+    // AO is in idle state. Finally leave control to task button again, it
+    // runs above this task and may create a new UI before the call returns.
+    ao_state_publish(&ao_ui_state, AO_UI_IDLE);
+
     ao_deinit(ao_ui); /*< End of task. No more execution after this point*/
     break;
   }
@@ -153,35 +171,67 @@ static void ao_ui_ev_f(ao_msg_t *ao_msg) {
   }
   }
 
-  // Turn off previous led based in previous UI state.
-  if (need_turn_off)
-    ao_ui_turn_off_previous_led(ao_msg->receiver, ao_ui_previous);
+  // Apply the new target to the led group from this task, no queue round
+  // trip. A single message turns off the previous led and turns on the new
+  // one. The sender is the ao_ui.
+  if (need_update)
+    ao_call(ao_led_group, ao_msg->receiver, (uint8_t *)&ao_led_msg,
+            sizeof(ao_led_msg));
 
   // Destroy user interface to save resources.
   if (need_destroy) {
     ao_ui_message_t ui_msg = AO_UI_PRESS_DESTROY;
-    ao_send_message(ao_msg->receiver, NULL, (uint8_t *)&ui_msg, sizeof(ui_msg));
+    // Sent as itself, the limits on the button events do not apply.
+    ao_send_message(ao_msg->receiver, ao_msg->receiver, (uint8_t *)&ui_msg,
+                    sizeof(ui_msg));
   }
+}
 
-  // Send message to led AO. If ao_led_target is null this part does/send
-  // nothing. The receiver is the ao_ui.
-  ao_send_message(ao_led_target, ao_msg->receiver, &ao_led_msg,
-                  sizeof(ao_led_msg));
+static void ao_ui_overflow_f(ao_t ao, ao_msg_t *ao_msg) {
+  ao_overflow_stats_t stats;
+  ao_get_overflow_stats(ao, &stats);
+  LOGGER_INFO("UI busy, event %d dropped (%lu)", (int)ao_msg->ao_msg[0],
+              (unsigned long)stats.dropped);
 }
 
-static void ao_ui_free_f(ao_msg_t *ao_msg) { ao_generic_free_message(ao_msg); }
+static void ao_ui_deadline_f(ao_t ao, const ao_deadline_miss_t *ao_miss) {
+  LOGGER_INFO("UI event %d missed: wait %lu run %lu us",
+              (int)ao_miss->ao_msg.ao_msg[0],
+              (unsigned long)(ao_miss->wait / cycles_per_us),
+              (unsigned long)(ao_miss->run / cycles_per_us));
+#if TRACE_MODE_SNAPSHOT == TRACE_RECORDER_CONFIG_MODE
+  // Keep what led to the miss for a dump.
+  trace_recorder_stop();
+#endif
+  // And the messages, to replay them.
+  ao_journal_stop();
+}
 
-ao_ui_state_t ao_ui_get_state(void) { return ao_ui_state; }
+ao_ui_state_t ao_ui_get_state(void) {
+  return (ao_ui_state_t)ao_state_get(&ao_ui_state);
+}
+
+bool ao_ui_wait_state(ao_ui_state_t state, uint32_t timeout_ms) {
+  return ao_state_wait(&ao_ui_state, AO_STATE_BIT(state), timeout_ms);
+}
 
 ao_t ao_ui_init(void) {
   // Initialize User Interface AO.
-  ao_t ao = ao_init(NULL, 0, ao_ui_ev_f, ao_ui_free_f, 0);
+  static const ao_config_t ao_ui_cfg = {.name = "ao_ui",
+                                        .queue_len = AO_UI_QUEUE_LEN_};
+  ao_t ao = ao_init(NULL, 0, ao_ui_ev_f, NULL, 0, &ao_ui_cfg);
+  // Bursts of presses keep the latest ones.
+  ao_set_overflow_policy(ao, AO_POLICY_DROP_OLDEST, 0, ao_ui_overflow_f);
+  // Button events come without sender.
+  ao_set_rate_limit(ao, NULL, AO_UI_RATE_PER_S_, AO_UI_RATE_BURST_);
+  ao_set_admission(ao, AO_UI_MAX_PENDING_);
+  ao_set_deadline(ao, AO_UI_WAIT_BUDGET_US_, AO_UI_RUN_BUDGET_US_,
+                  ao_ui_deadline_f);
   // User Interface has the task of initialize necessary led.
-  ao_led_r = ao_led_init(LED_RED_PORT, LED_RED_PIN);
-  ao_led_g = ao_led_init(LED_GREEN_PORT, LED_GREEN_PIN);
-  ao_led_b = ao_led_init(LED_BLUE_PORT, LED_BLUE_PIN);
+  ao_led_group = ao_led_group_init(
+      ao_ui_leds, (uint8_t)(sizeof(ao_ui_leds) / sizeof(ao_ui_leds[0])));
   // Ready to go.
-  ao_ui_state = AO_UI_READY;
+  ao_state_init(&ao_ui_state, AO_UI_READY);
   return ao;
 }
 
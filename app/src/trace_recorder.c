@@ -0,0 +1,267 @@
+/*
+ * trace_recorder.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "trace_recorder.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "linker_sections.h"
+#include "main.h"
+#include "stack_monitor.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*< Stack depth in words of the stream task */
+#define TRACE_RECORDER_STREAM_STACK_SIZE (128)
+
+#if 1 == configUSE_TRACE_RECORDER
+
+/*< Recorder memory, the snapshot layout of trace_format.h */
+typedef struct {
+  trace_header_t header;
+  trace_obj_t obj[TRACE_RECORDER_CONFIG_MAX_OBJECTS];
+  trace_rec_t rec[TRACE_RECORDER_CONFIG_RECORDS];
+} trace_buffer_t;
+
+_Static_assert((TRACE_RECORDER_CONFIG_RECORDS &
+                (TRACE_RECORDER_CONFIG_RECORDS - 1)) == 0,
+               "Trace ring records must be a power of two");
+
+/*< Not static, the debugger dumps it by name */
+trace_buffer_t trace_buffer LINKER_SECTION_CCM;
+
+static struct {
+  volatile bool running;
+  volatile uint32_t tail;  /*< Next record to stream */
+  volatile bool obj_dirty; /*< Object table to stream again */
+  uint8_t obj_next;        /*< Object entry replaced next */
+  uint8_t task_id;         /*< Last task id given */
+  uint8_t queue_id;        /*< Last queue id given */
+#if TRACE_MODE_STREAM == TRACE_RECORDER_CONFIG_MODE
+  /* Copies streamed out of the scheduler lock */
+  trace_header_t header;
+  trace_obj_t obj[TRACE_RECORDER_CONFIG_MAX_OBJECTS];
+#endif
+} trace_recorder;
+
+extern UART_HandleTypeDef huart3;
+
+/**
+ * @brief Mask every interrupt, also the ones over the kernel.
+ *
+ * @return uint32_t Previous mask, for trace_recorder_unlock_.
+ */
+static uint32_t trace_recorder_lock_(void) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+
+static void trace_recorder_unlock_(uint32_t primask) { __set_PRIMASK(primask); }
+
+/**
+ * @brief Next id of a kind, NO_ID is never given.
+ *
+ * @param last Last id given.
+ * @return uint8_t Id.
+ */
+static uint8_t trace_recorder_next_id_(uint8_t *last) {
+  uint32_t primask = trace_recorder_lock_();
+  if (++(*last) == TRACE_FORMAT_NO_ID)
+    ++(*last);
+  uint8_t id = *last;
+  trace_recorder_unlock_(primask);
+  return id;
+}
+
+#if TRACE_MODE_STREAM == TRACE_RECORDER_CONFIG_MODE
+static void trace_recorder_write_(const void *data, uint16_t size) {
+  HAL_UART_Transmit(&huart3, (uint8_t *)data, size, HAL_MAX_DELAY);
+}
+
+static void trace_recorder_frame_(uint8_t kind, const void *items,
+                                  uint16_t count, uint16_t item_size) {
+  trace_frame_t frame = {
+      .magic = TRACE_FORMAT_FRAME_MAGIC, .kind = kind, .count = count};
+  trace_recorder_write_(&frame, sizeof(frame));
+  trace_recorder_write_(items, (uint16_t)(count * item_size));
+}
+
+/**
+ * @brief Drain the ring to the UART.
+ *
+ * @note Records are written in place, producers do not reuse them until the
+ * tail moves past. The object table is sent again whenever it changes.
+ *
+ * @param argument Not used.
+ */
+static void trace_recorder_stream_(void *argument) {
+  TickType_t last_wake = xTaskGetTickCount();
+  trace_recorder.obj_dirty = true;
+
+  for (;;) {
+    if (trace_recorder.obj_dirty) {
+      trace_recorder.obj_dirty = false;
+      // Objects are named by tasks only, none while copying. The UART
+      // blocks, it is written with the scheduler running.
+      vTaskSuspendAll();
+      trace_recorder.header = trace_buffer.header;
+      memcpy(trace_recorder.obj, trace_buffer.obj, sizeof(trace_buffer.obj));
+      xTaskResumeAll();
+      trace_recorder_frame_(TRACE_FRAME_HEADER, &trace_recorder.header, 1,
+                            sizeof(trace_header_t));
+      trace_recorder_frame_(TRACE_FRAME_OBJECTS, trace_recorder.obj,
+                            TRACE_RECORDER_CONFIG_MAX_OBJECTS,
+                            sizeof(trace_obj_t));
+    }
+
+    uint32_t head = trace_buffer.header.head;
+    while (trace_recorder.tail != head) {
+      uint32_t index =
+          trace_recorder.tail & (TRACE_RECORDER_CONFIG_RECORDS - 1U);
+      uint32_t count = head - trace_recorder.tail;
+      // Up to the end of the ring, the rest goes in the next frame.
+      if (count > TRACE_RECORDER_CONFIG_RECORDS - index)
+        count = TRACE_RECORDER_CONFIG_RECORDS - index;
+      trace_recorder_frame_(TRACE_FRAME_RECORDS, &trace_buffer.rec[index],
+                            (uint16_t)count, sizeof(trace_rec_t));
+      trace_recorder.tail += count;
+    }
+
+    vTaskDelayUntil(&last_wake,
+                    pdMS_TO_TICKS(TRACE_RECORDER_CONFIG_STREAM_PERIOD_MS));
+  }
+}
+#endif
+
+#endif
+
+void trace_recorder_init(void) {
+#if 1 == configUSE_TRACE_RECORDER
+  trace_header_t *header = &trace_buffer.header;
+  header->magic = TRACE_FORMAT_MAGIC;
+  header->version = TRACE_FORMAT_VERSION;
+  header->mode = TRACE_RECORDER_CONFIG_MODE;
+  header->objects = TRACE_RECORDER_CONFIG_MAX_OBJECTS;
+  header->cpu_hz = SystemCoreClock;
+  header->capacity = TRACE_RECORDER_CONFIG_RECORDS;
+
+  // Interrupt handlers calling trace_recorder_isr_enter.
+  trace_recorder_name(TRACE_OBJ_ISR, (uint8_t)(TIM2_IRQn + 16), "TIM2");
+
+  trace_recorder_start();
+
+#if TRACE_MODE_STREAM == TRACE_RECORDER_CONFIG_MODE
+  TaskHandle_t task;
+  if (xTaskCreate(trace_recorder_stream_, "trace_stream",
+                  TRACE_RECORDER_STREAM_STACK_SIZE, NULL, tskIDLE_PRIORITY,
+                  &task) == pdPASS)
+    stack_monitor_register(task, "trace_stream",
+                           TRACE_RECORDER_STREAM_STACK_SIZE);
+#endif
+#endif
+}
+
+void trace_recorder_start(void) {
+#if 1 == configUSE_TRACE_RECORDER
+  uint32_t primask = trace_recorder_lock_();
+  {
+    trace_buffer.header.head = 0;
+    trace_buffer.header.dropped = 0;
+    trace_recorder.tail = 0;
+    trace_recorder.obj_dirty = true;
+    trace_recorder.running = true;
+  }
+  trace_recorder_unlock_(primask);
+#endif
+}
+
+void trace_recorder_stop(void) {
+#if 1 == configUSE_TRACE_RECORDER
+  trace_recorder.running = false;
+#endif
+}
+
+void trace_recorder_put(uint8_t type, uint8_t id, uint16_t arg) {
+#if 1 == configUSE_TRACE_RECORDER
+  if (!trace_recorder.running ||
+      !(TRACE_RECORDER_CONFIG_FILTER & TRACE_REC_BIT(type)))
+    return;
+
+  uint32_t primask = trace_recorder_lock_();
+  {
+    uint32_t head = trace_buffer.header.head;
+    if (TRACE_MODE_STREAM == TRACE_RECORDER_CONFIG_MODE &&
+        head - trace_recorder.tail >= TRACE_RECORDER_CONFIG_RECORDS) {
+      trace_buffer.header.dropped++; // Not streamed yet, keep the oldest.
+    } else {
+      trace_rec_t *rec =
+          &trace_buffer.rec[head & (TRACE_RECORDER_CONFIG_RECORDS - 1U)];
+      rec->cyc = cycle_counter_get();
+      rec->type = type;
+      rec->id = id;
+      rec->arg = arg;
+      trace_buffer.header.head = head + 1U;
+    }
+  }
+  trace_recorder_unlock_(primask);
+#endif
+}
+
+void trace_recorder_name(uint8_t kind, uint8_t id, const char *name) {
+#if 1 == configUSE_TRACE_RECORDER
+  if (name == NULL)
+    return;
+
+  uint32_t primask = trace_recorder_lock_();
+  {
+    trace_obj_t *obj = NULL;
+    for (uint8_t i = 0; i < TRACE_RECORDER_CONFIG_MAX_OBJECTS; i++) {
+      if (trace_buffer.obj[i].kind == kind && trace_buffer.obj[i].id == id) {
+        obj = &trace_buffer.obj[i]; // Renamed, or its id given again.
+        break;
+      }
+    }
+    if (obj == NULL) {
+      obj = &trace_buffer.obj[trace_recorder.obj_next];
+      trace_recorder.obj_next =
+          (trace_recorder.obj_next + 1U) % TRACE_RECORDER_CONFIG_MAX_OBJECTS;
+    }
+    obj->kind = kind;
+    obj->id = id;
+    strncpy(obj->name, name, sizeof(obj->name));
+    trace_recorder.obj_dirty = true;
+  }
+  trace_recorder_unlock_(primask);
+#endif
+}
+
+uint8_t trace_recorder_on_task_create(const char *name) {
+#if 1 == configUSE_TRACE_RECORDER
+  uint8_t id = trace_recorder_next_id_(&trace_recorder.task_id);
+  trace_recorder_name(TRACE_OBJ_TASK, id, name);
+  return id;
+#else
+  return TRACE_FORMAT_NO_ID;
+#endif
+}
+
+uint8_t trace_recorder_on_queue_create(void) {
+#if 1 == configUSE_TRACE_RECORDER
+  uint8_t id = trace_recorder_next_id_(&trace_recorder.queue_id);
+  trace_recorder_name(TRACE_OBJ_QUEUE, id, "queue");
+  return id;
+#else
+  return TRACE_FORMAT_NO_ID;
+#endif
+}
+
+void trace_recorder_isr_enter(void) {
+  trace_recorder_put(TRACE_REC_ISR_ENTER, (uint8_t)__get_IPSR(), 0);
+}
+
+void trace_recorder_isr_exit(void) {
+  trace_recorder_put(TRACE_REC_ISR_EXIT, (uint8_t)__get_IPSR(), 0);
+}
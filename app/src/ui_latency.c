@@ -0,0 +1,153 @@
+/*
+ * ui_latency.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "ui_latency.h"
+#include "cmsis_os.h"
+#include "dwt.h"
+#include "logger.h"
+#include "main.h"
+#include <string.h>
+
+/*< No press in flight */
+#define UI_LATENCY_NONE_ (-1)
+
+/*< Scripted press: time held, then time released */
+typedef struct {
+  uint16_t hold_ms;
+  uint16_t release_ms;
+} ui_latency_press_t;
+
+#if 1 == UI_LATENCY_CONFIG_ENABLE
+
+/* Pulse, short and long with the button task timeouts, then the UI idles */
+static const ui_latency_press_t ui_latency_script_[] = {
+    {.hold_ms = 300, .release_ms = 700},
+    {.hold_ms = 1200, .release_ms = 800},
+    {.hold_ms = 2300, .release_ms = 11000},
+};
+
+static const char *const ui_latency_names_[UI_LATENCY__N] = {
+    [UI_LATENCY_EDGE] = "total",  [UI_LATENCY_GESTURE] = "gesture",
+    [UI_LATENCY_UI] = "ui",       [UI_LATENCY_LED] = "led",
+    [UI_LATENCY_GPIO] = "gpio",
+};
+
+static struct {
+  uint32_t stamp[UI_LATENCY__N]; /*< Stages of the press in flight */
+  int8_t reached;                /*< Last stage reached, or NONE */
+  /* Stage times of the last presses, the whole press in place of the edge */
+  uint32_t sample[UI_LATENCY__N][UI_LATENCY_CONFIG_SAMPLES];
+  uint32_t presses; /*< Presses done */
+  uint32_t dropped; /*< Presses that changed no led */
+  uint32_t sorted[UI_LATENCY_CONFIG_SAMPLES]; /*< Percentile scratch */
+  uint32_t script_ms;                         /*< Time in the script step */
+  uint8_t script_step;                        /*< Press of the script */
+} ui_latency = {.reached = UI_LATENCY_NONE_};
+
+/**
+ * @brief Keep the stage times of the press in flight, it is done.
+ */
+static void ui_latency_add_(void) {
+  uint32_t slot = ui_latency.presses % UI_LATENCY_CONFIG_SAMPLES;
+  ui_latency.sample[UI_LATENCY_EDGE][slot] =
+      ui_latency.stamp[UI_LATENCY_GPIO] - ui_latency.stamp[UI_LATENCY_EDGE];
+  for (uint8_t s = UI_LATENCY_GESTURE; s < UI_LATENCY__N; s++)
+    ui_latency.sample[s][slot] = ui_latency.stamp[s] - ui_latency.stamp[s - 1];
+  ui_latency.presses++;
+}
+
+#endif
+
+void ui_latency_mark(ui_latency_stage_t stage) {
+#if 1 == UI_LATENCY_CONFIG_ENABLE
+  uint32_t now = cycle_counter_get();
+  if (stage >= UI_LATENCY__N)
+    return;
+
+  taskENTER_CRITICAL();
+  {
+    if (stage == UI_LATENCY_EDGE) {
+      if (ui_latency.reached >= UI_LATENCY_GESTURE)
+        ui_latency.dropped++; // Classified, but no led changed.
+      ui_latency.stamp[stage] = now;
+      ui_latency.reached = UI_LATENCY_EDGE;
+    } else if (ui_latency.reached == (int8_t)stage - 1) {
+      ui_latency.stamp[stage] = now;
+      ui_latency.reached = (int8_t)stage;
+      if (stage == UI_LATENCY_GPIO) {
+        ui_latency_add_();
+        ui_latency.reached = UI_LATENCY_NONE_;
+      }
+    }
+  }
+  taskEXIT_CRITICAL();
+#endif
+}
+
+uint32_t ui_latency_percentile(ui_latency_stage_t stage, uint8_t pct) {
+#if 1 == UI_LATENCY_CONFIG_ENABLE
+  if (stage >= UI_LATENCY__N || pct == 0 || pct > 100)
+    return 0;
+
+  uint32_t *sorted = ui_latency.sorted;
+  uint32_t count;
+  taskENTER_CRITICAL();
+  {
+    count = ui_latency.presses < UI_LATENCY_CONFIG_SAMPLES
+                ? ui_latency.presses
+                : UI_LATENCY_CONFIG_SAMPLES;
+    memcpy(sorted, ui_latency.sample[stage], count * sizeof(sorted[0]));
+  }
+  taskEXIT_CRITICAL();
+  if (count == 0)
+    return 0;
+
+  // Insertion sort, a few tens of samples.
+  for (uint32_t i = 1; i < count; i++) {
+    uint32_t v = sorted[i];
+    uint32_t j = i;
+    for (; j > 0 && sorted[j - 1] > v; j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = v;
+  }
+  // Nearest rank.
+  uint32_t rank = (count * pct + 99U) / 100U;
+  return sorted[rank - 1U];
+#else
+  return 0;
+#endif
+}
+
+void ui_latency_report(void) {
+#if 1 == UI_LATENCY_CONFIG_ENABLE
+  LOGGER_INFO("Button to led: presses %lu dropped %lu",
+              (unsigned long)ui_latency.presses,
+              (unsigned long)ui_latency.dropped);
+  for (uint8_t s = 0; s < UI_LATENCY__N; s++) {
+    LOGGER_INFO("  %-7s p50 %lu p90 %lu max %lu us", ui_latency_names_[s],
+                (unsigned long)(ui_latency_percentile(s, 50) / cycles_per_us),
+                (unsigned long)(ui_latency_percentile(s, 90) / cycles_per_us),
+                (unsigned long)(ui_latency_percentile(s, 100) / cycles_per_us));
+  }
+#endif
+}
+
+bool ui_latency_script(uint32_t period_ms) {
+#if 1 == UI_LATENCY_CONFIG_ENABLE
+  const ui_latency_press_t *press = &ui_latency_script_[ui_latency.script_step];
+  ui_latency.script_ms += period_ms;
+  if (ui_latency.script_ms >= press->hold_ms + press->release_ms) {
+    ui_latency.script_ms = 0;
+    ui_latency.script_step = (uint8_t)((ui_latency.script_step + 1U) %
+                                       (sizeof(ui_latency_script_) /
+                                        sizeof(ui_latency_script_[0])));
+    press = &ui_latency_script_[ui_latency.script_step];
+  }
+  return ui_latency.script_ms < press->hold_ms;
+#else
+  return false;
+#endif
+}
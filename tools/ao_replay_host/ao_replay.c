@@ -0,0 +1,153 @@
+/*
+ * ao_replay.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+/*
+ * Host replay of the AO journal (app/inc/ao_journal.h).
+ *
+ * Reads the memory of 'ao_journal_buffer' dumped by the debugger and feeds
+ * it, through ao_journal_replay, to a fresh UI and led group: the real AO
+ * core and handlers, built against a single task kernel (fake/) and the led
+ * port of tools/led_pattern_host. Nothing of the board is touched and the
+ * replay starts from the state the UI is created with. The handlers log to
+ * stdout, then the replay results and the leds left on are printed.
+ *
+ * Build and run, from the repository root:
+ *   tools/ao_replay_host/check.sh builds it and replays the fixtures.
+ *   ao_replay journal.bin
+ *
+ * Only the last UI journaled is replayed, the messages of the ones torn
+ * down before are skipped (see AO_JOURNAL_ID). The replay run times count
+ * reads of a fake cycle counter, see fake/dwt.h.
+ */
+
+#include "ao_journal.h"
+#include "board.h"
+#include "fake_port.h"
+#include "led_pattern.h"
+#include "task_ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*< Dump header: capacity and head words, as ao_journal_buffer_t */
+#define REPLAY_HEADER_SIZE (8U)
+
+static uint8_t *replay_read_(const char *path, size_t *size) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    perror(path);
+    return NULL;
+  }
+  size_t cap = 1 << 12, len = 0;
+  uint8_t *data = malloc(cap);
+  size_t n;
+  while (data != NULL && (n = fread(data + len, 1, cap - len, f)) > 0) {
+    len += n;
+    if (len == cap) {
+      uint8_t *grown = realloc(data, cap * 2);
+      if (grown == NULL)
+        free(data);
+      data = grown;
+      cap *= 2;
+    }
+  }
+  if (data == NULL)
+    fprintf(stderr, "%s: out of memory\n", path);
+  else if (ferror(f)) {
+    perror(path);
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  *size = len;
+  return data;
+}
+
+/**
+ * @brief Take the entries out of a journal dump, oldest first.
+ *
+ * @param data Dump.
+ * @param size Dump size.
+ * @param count Where the number of entries is returned.
+ * @return ao_journal_entry_t* Entries, NULL if the dump is not a journal.
+ */
+static ao_journal_entry_t *replay_entries_(const uint8_t *data, size_t size,
+                                           uint32_t *count) {
+  uint32_t capacity, head;
+  if (size < REPLAY_HEADER_SIZE)
+    return NULL;
+  memcpy(&capacity, data, sizeof(capacity));
+  memcpy(&head, data + sizeof(capacity), sizeof(head));
+  if (capacity == 0 || (capacity & (capacity - 1U)) != 0 ||
+      size != REPLAY_HEADER_SIZE + capacity * sizeof(ao_journal_entry_t))
+    return NULL;
+
+  *count = head < capacity ? head : capacity;
+  ao_journal_entry_t *entries = calloc(capacity, sizeof(*entries));
+  if (entries == NULL)
+    return NULL;
+  // The newest 'count' entries, oldest first.
+  uint32_t first = head - *count;
+  for (uint32_t i = 0; i < *count; i++)
+    memcpy(&entries[i],
+           data + REPLAY_HEADER_SIZE +
+               ((first + i) & (capacity - 1U)) * sizeof(ao_journal_entry_t),
+           sizeof(ao_journal_entry_t));
+  printf("Journal: %lu entries, %lu overwritten\n", (unsigned long)*count,
+         (unsigned long)(head - *count));
+  return entries;
+}
+
+static const char *replay_led_(GPIO_TypeDef *port, uint16_t pin) {
+  bool on = ((port->ODR & pin) != 0) == (LED_ON == GPIO_PIN_SET);
+  return on ? "on" : "off";
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <ao_journal_buffer dump>\n", argv[0]);
+    return 1;
+  }
+  size_t size;
+  uint8_t *data = replay_read_(argv[1], &size);
+  if (data == NULL)
+    return 1;
+  uint32_t count = 0;
+  ao_journal_entry_t *entries = replay_entries_(data, size, &count);
+  free(data);
+  if (entries == NULL) {
+    fprintf(stderr, "%s: not an AO journal dump\n", argv[1]);
+    return 1;
+  }
+
+  // Fresh AOs, as the firmware creates them: the UI then its led group.
+  led_pattern_init();
+  if (ao_ui_init() == NULL) {
+    fprintf(stderr, "UI not created\n");
+    free(entries);
+    return 1;
+  }
+
+  ao_journal_replay_stats_t stats;
+  int err = ao_journal_replay(entries, count, &stats);
+  free(entries);
+  if (err != AO_OK) {
+    fprintf(stderr, "replay failed (%d)\n", err);
+    return 1;
+  }
+  ao_journal_report(&stats);
+  // The group sets the new led and resets the previous one in one store per
+  // port, the last one gives the leds left on.
+  fake_gpio_latch(LED_RED_PORT);
+  fake_gpio_latch(LED_GREEN_PORT);
+  fake_gpio_latch(LED_BLUE_PORT);
+  printf("Leds: red %s, green %s, blue %s\n",
+         replay_led_(LED_RED_PORT, LED_RED_PIN),
+         replay_led_(LED_GREEN_PORT, LED_GREEN_PIN),
+         replay_led_(LED_BLUE_PORT, LED_BLUE_PIN));
+  return stats.diverged ? 2 : 0;
+}
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Build the host replay against the AO core, the UI and the led group, replay
+# the journal fixtures and compare the output with fixtures/expected. Run
+# from anywhere. With --update the expected output is rewritten instead,
+# review its diff before committing.
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+repo="$here/../.."
+fixtures="$here/fixtures"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+${CC:-cc} -std=gnu11 -Wall -Wextra -Werror -Wno-unused-parameter \
+  -DAO_JOURNAL_CONFIG_ENABLE=1 \
+  -I"$here/fake" -I"$repo/tools/led_pattern_host/fake" -I"$repo/app/inc" \
+  "$here/ao_replay.c" "$here/fake/fake_os.c" "$here/fake/fake_app.c" \
+  "$repo/tools/led_pattern_host/fake/fake_port.c" \
+  "$repo/app/src/ao_api.c" "$repo/app/src/ao_journal.c" \
+  "$repo/app/src/ao_state.c" "$repo/app/src/task_ui.c" \
+  "$repo/app/src/task_led.c" "$repo/app/src/led_pattern.c" \
+  -o "$out/ao_replay"
+
+status=0
+for name in session diverged; do
+  # Exits 2 on a divergence, part of the output.
+  rc=0
+  "$out/ao_replay" "$fixtures/$name.bin" > "$out/$name.txt" 2>&1 || rc=$?
+  echo "exit $rc" >> "$out/$name.txt"
+  if [ "$1" = "--update" ]; then
+    cp "$out/$name.txt" "$fixtures/expected/$name.txt"
+  elif ! diff -u "$fixtures/expected/$name.txt" "$out/$name.txt"; then
+    status=1
+  fi
+done
+
+[ $status -eq 0 ] && echo "ao_replay_host: ok"
+exit $status
@@ -0,0 +1,81 @@
+/*
+ * cmsis_os.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef FAKE_CMSIS_OS_H_
+#define FAKE_CMSIS_OS_H_
+
+/*
+ * Host stand-in of the FreeRTOS calls made by the AO core, the UI and the
+ * published states. The replay is the only task: created tasks never run,
+ * nothing blocks and critical sections are empty. Queues keep what they are
+ * sent, only the AOs that have one drain them.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct fake_queue *QueueHandle_t;
+typedef struct fake_task *TaskHandle_t;
+typedef struct fake_event_group *EventGroupHandle_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL (pdFALSE)
+#define pdPASS (pdTRUE)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+#define errQUEUE_FULL ((BaseType_t)0)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+
+/* As Core/Inc/FreeRTOSConfig.h */
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define configMAX_PRIORITIES (7)
+#define configMINIMAL_STACK_SIZE ((uint16_t)128)
+#define configMAX_TASK_NAME_LEN (16)
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+
+#define pdMS_TO_TICKS(ms)                                                      \
+  ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define taskENTER_CRITICAL() ((void)0)
+#define taskEXIT_CRITICAL() ((void)0)
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint16_t depth,
+                       void *parameters, UBaseType_t priority,
+                       TaskHandle_t *task);
+void vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+UBaseType_t uxQueueGetQueueNumber(QueueHandle_t queue);
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear, BaseType_t all,
+                                TickType_t wait);
+
+void vPortFree(void *p);
+
+#endif /* FAKE_CMSIS_OS_H_ */
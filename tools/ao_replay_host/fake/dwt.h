@@ -0,0 +1,41 @@
+/*
+ * dwt.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef FAKE_DWT_H_
+#define FAKE_DWT_H_
+
+/*
+ * Host stand-in of app/inc/dwt.h. The cycle counter moves a fixed step on
+ * every read, so the run times of a replay are the same on every host: they
+ * count reads, not the target cycles.
+ */
+
+#include <stdint.h>
+
+/*< Cycles the counter moves on each read */
+#define FAKE_DWT_STEP (42U)
+
+#define cycle_counter_init() ((void)0)
+#define cycle_counter_reset() fake_cycle_counter_set(0)
+#define cycle_counter_get() fake_cycle_counter_get()
+#define cycles_per_us (168U)
+#define cycle_counter_time_us() (fake_cycle_counter_get() / cycles_per_us)
+
+/**
+ * @brief Read the fake cycle counter, then move it FAKE_DWT_STEP.
+ *
+ * @return uint32_t Cycles.
+ */
+uint32_t fake_cycle_counter_get(void);
+/**
+ * @brief Set the fake cycle counter.
+ *
+ * @param cycles Cycles.
+ */
+void fake_cycle_counter_set(uint32_t cycles);
+
+#endif /* FAKE_DWT_H_ */
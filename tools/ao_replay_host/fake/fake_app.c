@@ -0,0 +1,47 @@
+/*
+ * fake_app.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "cmsis_os.h"
+#include "logger.h"
+#include "stack_monitor.h"
+#include "trace_recorder.h"
+#include "ui_latency.h"
+
+/*
+ * Host stand-ins of the firmware services the AOs call. The logger prints to
+ * stdout, the monitors and the trace recorder are left out of the replay.
+ */
+
+static char logger_buffer_[LOGGER_CONFIG_MAXLEN];
+char *const logger_msg = logger_buffer_;
+int logger_msg_len;
+
+void logger_log_print_(char *const msg) { fputs(msg, stdout); }
+
+void stack_monitor_register(TaskHandle_t task, const char *name,
+                            uint16_t depth) {
+  (void)task;
+  (void)name;
+  (void)depth;
+}
+
+void stack_monitor_unregister(TaskHandle_t task) { (void)task; }
+
+void trace_recorder_stop(void) {}
+
+void trace_recorder_put(uint8_t type, uint8_t id, uint16_t arg) {
+  (void)type;
+  (void)id;
+  (void)arg;
+}
+
+void trace_recorder_name(uint8_t kind, uint8_t id, const char *name) {
+  (void)kind;
+  (void)id;
+  (void)name;
+}
+
+void ui_latency_mark(ui_latency_stage_t stage) { (void)stage; }
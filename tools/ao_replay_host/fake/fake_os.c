@@ -0,0 +1,179 @@
+/*
+ * fake_os.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "cmsis_os.h"
+#include "dwt.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Host kernel of the replay, see cmsis_os.h. The ticks follow the fake cycle
+ * counter, at the target clock.
+ */
+
+/*< Target core clock */
+#define FAKE_OS_CPU_HZ (168000000UL)
+
+struct fake_queue {
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t head;  /*< Oldest item */
+  UBaseType_t count; /*< Items queued */
+  UBaseType_t number;
+  uint8_t *items;
+};
+
+struct fake_task {
+  char name[configMAX_TASK_NAME_LEN];
+};
+
+struct fake_event_group {
+  EventBits_t bits;
+};
+
+static struct {
+  uint32_t cycles;
+  UBaseType_t queues;    /*< Queues created, numbers them */
+  struct fake_task main; /*< The replay, the task running */
+} fake_os = {.main = {.name = "replay"}};
+
+uint32_t fake_cycle_counter_get(void) {
+  uint32_t cycles = fake_os.cycles;
+  fake_os.cycles += FAKE_DWT_STEP;
+  return cycles;
+}
+
+void fake_cycle_counter_set(uint32_t cycles) { fake_os.cycles = cycles; }
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint16_t depth,
+                       void *parameters, UBaseType_t priority,
+                       TaskHandle_t *task) {
+  (void)code;
+  (void)depth;
+  (void)parameters;
+  (void)priority;
+  struct fake_task *created = calloc(1, sizeof(*created));
+  if (created == NULL)
+    return pdFAIL;
+  strncpy(created->name, name, sizeof(created->name) - 1U);
+  if (task != NULL)
+    *task = created;
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Never the replay, it is not deleted by the AO core.
+  if (task != NULL && task != &fake_os.main)
+    free(task);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return &fake_os.main; }
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(fake_os.cycles / (FAKE_OS_CPU_HZ / configTICK_RATE_HZ));
+}
+
+void vTaskDelay(TickType_t ticks) {
+  fake_os.cycles += ticks * (FAKE_OS_CPU_HZ / configTICK_RATE_HZ);
+}
+
+void vTaskSuspendAll(void) {}
+
+BaseType_t xTaskResumeAll(void) { return pdFALSE; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  (void)task;
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  (void)clear;
+  (void)wait;
+  return 0;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct fake_queue *queue = calloc(1, sizeof(*queue));
+  if (queue == NULL)
+    return NULL;
+  queue->items = calloc(length, item_size);
+  if (queue->items == NULL) {
+    free(queue);
+    return NULL;
+  }
+  queue->length = length;
+  queue->item_size = item_size;
+  queue->number = ++fake_os.queues;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  if (queue == NULL)
+    return;
+  free(queue->items);
+  free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+  (void)wait; // Nothing would make room.
+  if (queue->count == queue->length)
+    return errQUEUE_FULL;
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+  queue->count++;
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+  (void)wait; // Nothing would send meanwhile.
+  if (queue->count == 0)
+    return errQUEUE_EMPTY;
+  memcpy(item, queue->items + queue->head * queue->item_size,
+         queue->item_size);
+  queue->head = (queue->head + 1U) % queue->length;
+  queue->count--;
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+  return queue->length - queue->count;
+}
+
+UBaseType_t uxQueueGetQueueNumber(QueueHandle_t queue) {
+  return queue->number;
+}
+
+EventGroupHandle_t xEventGroupCreate(void) {
+  return calloc(1, sizeof(struct fake_event_group));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+  group->bits |= bits;
+  return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+  EventBits_t before = group->bits;
+  group->bits &= ~bits;
+  return before;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear, BaseType_t all,
+                                TickType_t wait) {
+  (void)all;
+  (void)wait; // Nothing would set them meanwhile.
+  EventBits_t now = group->bits;
+  if (clear && (now & bits))
+    group->bits &= ~bits;
+  return now;
+}
+
+void vPortFree(void *p) { free(p); }
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# make_fixtures.py
+#
+#  Created on: Oct 18, 2026
+#      Author: guirespi
+#
+# Writes the ao_replay fixtures, 'ao_journal_buffer' as dumped by the
+# debugger, laid out as app/inc/ao_journal.h:
+#   session.bin   A UI used then torn down on idle, and the next one, created
+#                 on a press. The ring wrapped, it starts past a root.
+#   diverged.bin  The same, with the led group of the last UI called with
+#                 another mask than the handlers give.
+#
+# The fixtures are committed, run this only to change them, then refresh
+# the expected output with 'check.sh --update'.
+
+import os
+import struct
+
+CAPACITY = 64
+CPU_HZ = 168000000
+MAX_MSG_SIZE = 16
+
+NO_AO = 0xFF
+SLOT_BITS = 4
+F_ROOT, F_CALL = 1 << 0, 1 << 1
+
+# ao_ui_message_t, sent as the enum, 4 bytes
+PULSE, SHORT, LONG, IDLE, DESTROY = 1, 2, 3, 4, 5
+# Led group mask bit of each press, in task_ui.c
+MASK = {PULSE: 0x01, SHORT: 0x02, LONG: 0x04}
+
+# Slots as the firmware creates them: the UI then its led group.
+UI, LEDS = 0, 1
+
+
+def ao_id(slot, gen):
+    return (gen << SLOT_BITS | slot) & 0xFF
+
+
+def entry(cyc, sender, receiver, payload, flags):
+    return struct.pack("<IBBBB", cyc & 0xFFFFFFFF, sender, receiver,
+                       len(payload), flags) + \
+        payload.ljust(MAX_MSG_SIZE, b"\0")
+
+
+def ui_session(gen, presses, t, idle=True):
+    """Entries of a UI of generation 'gen' handling 'presses' from 't' ms,
+    as journaled: the press from the button task, then the led group call
+    of its handler if the led changes. Torn down at the end if 'idle'."""
+    ui, leds = ao_id(UI, gen), ao_id(LEDS, gen)
+    out, lit = [], None
+    for press in presses:
+        cyc = t * (CPU_HZ // 1000)
+        out.append(entry(cyc, NO_AO, ui, struct.pack("<I", press), F_ROOT))
+        if lit != press:
+            out.append(entry(cyc + 900, ui, leds,
+                             bytes([MASK[press], 0]), F_CALL))
+            lit = press
+        t += 700
+    if idle:
+        cyc = (t + 10000) * (CPU_HZ // 1000)
+        out.append(entry(cyc, NO_AO, ui, struct.pack("<I", IDLE), F_ROOT))
+        out.append(entry(cyc + 900, ui, leds, bytes([0, 0]), F_CALL))
+        out.append(entry(cyc + 1800, ui, ui, struct.pack("<I", DESTROY), 0))
+    return out
+
+
+def session(diverge):
+    first = ui_session(1, [PULSE, SHORT, LONG] * 10 + [SHORT, SHORT], 0)
+    last = ui_session(2, [PULSE, PULSE, SHORT, LONG, SHORT], 40000,
+                      idle=False)
+    if diverge:
+        # The call of the LONG press, blue, journaled as green.
+        at = next(i for i, e in enumerate(last)
+                  if e[5] == ao_id(LEDS, 2) and e[8] == MASK[LONG])
+        e = bytearray(last[at])
+        e[8] = MASK[SHORT]
+        last[at] = bytes(e)
+    return first + last
+
+
+def dump(path, entries):
+    head = len(entries)
+    ring = [b"\0" * len(entries[0])] * CAPACITY
+    for i, e in enumerate(entries):
+        ring[i % CAPACITY] = e
+    with open(path, "wb") as f:
+        f.write(struct.pack("<II", CAPACITY, head))
+        f.write(b"".join(ring))
+
+
+if __name__ == "__main__":
+    here = os.path.dirname(os.path.abspath(__file__))
+    dump(os.path.join(here, "session.bin"), session(False))
+    dump(os.path.join(here, "diverged.bin"), session(True))
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Build the led pattern engine against the fake timer and GPIO, play every
+# pattern and compare the leds with expected.txt. Run from anywhere.
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+repo="$here/../.."
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+${CC:-cc} -std=gnu11 -Wall -Wextra -Werror \
+  -I"$here/fake" -I"$repo/app/inc" \
+  "$here/led_pattern_check.c" "$here/fake/fake_port.c" \
+  "$repo/app/src/led_pattern.c" -o "$out/led_pattern_check"
+
+"$out/led_pattern_check" > "$out/actual.txt"
+diff -u "$here/expected.txt" "$out/actual.txt"
+echo "led_pattern_host: ok"
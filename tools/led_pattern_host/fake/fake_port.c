@@ -0,0 +1,90 @@
+/*
+ * fake_port.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+#include "fake_port.h"
+#include "board.h"
+#include "led_pattern_port.h"
+#include <stddef.h>
+
+/*
+ * Host layer of the led pattern engine, in place of led_pattern_port.c. A
+ * millisecond clock stands for TIM8 and each step copies the next word into
+ * the destination register, as DMA2 does in circular mode.
+ */
+
+GPIO_TypeDef fake_gpiob;
+GPIO_TypeDef fake_gpioc;
+
+static struct {
+  volatile uint32_t *dst;
+  const uint32_t *src;
+  uint16_t count;
+  uint16_t step_ms;
+  uint16_t next;    /*< Next word to write */
+  uint32_t elapsed; /*< Time in the current step */
+  uint32_t writes;  /*< Words written since the start */
+  volatile uint32_t ccr;
+  bool pwm; /*< The PWM led is routed to the timer */
+} fake_port;
+
+void led_pattern_port_init(void) {
+  fake_port.dst = NULL;
+  fake_port.ccr = 0;
+  fake_port.pwm = false;
+}
+
+void led_pattern_port_start(volatile uint32_t *dst, const uint32_t *src,
+                            uint16_t count, uint16_t step_ms) {
+  fake_port.dst = dst;
+  fake_port.src = src;
+  fake_port.count = count;
+  fake_port.step_ms = step_ms;
+  fake_port.next = 0;
+  fake_port.elapsed = 0;
+  fake_port.writes = 0;
+}
+
+void led_pattern_port_stop(void) { fake_port.dst = NULL; }
+
+volatile uint32_t *led_pattern_port_pwm_attach(GPIO_TypeDef *port,
+                                               uint16_t pin) {
+  if (port != LED_A_PORT || pin != LED_A_PIN)
+    return NULL;
+  fake_port.pwm = true;
+  return &fake_port.ccr;
+}
+
+void led_pattern_port_pwm_detach(void) { fake_port.pwm = false; }
+
+uint32_t led_pattern_port_pwm_period(void) { return FAKE_PORT_PWM_PERIOD; }
+
+void fake_gpio_latch(GPIO_TypeDef *port) {
+  uint32_t bsrr = port->BSRR;
+  // Reset bits in the high half, set bits win when both are written.
+  port->ODR &= ~(bsrr >> 16U);
+  port->ODR |= bsrr & 0xFFFFU;
+  port->BSRR = 0;
+}
+
+void fake_timer_run(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t++) {
+    if (fake_port.dst == NULL)
+      return;
+    if (++fake_port.elapsed < fake_port.step_ms)
+      continue;
+    fake_port.elapsed = 0;
+    *fake_port.dst = fake_port.src[fake_port.next];
+    fake_port.next = (uint16_t)((fake_port.next + 1U) % fake_port.count);
+    fake_port.writes++;
+    fake_gpio_latch(GPIOB);
+  }
+}
+
+uint32_t fake_pwm_compare(void) { return fake_port.pwm ? fake_port.ccr : 0; }
+
+bool fake_timer_running(void) { return fake_port.dst != NULL; }
+
+uint32_t fake_dma_writes(void) { return fake_port.writes; }
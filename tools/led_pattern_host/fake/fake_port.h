@@ -0,0 +1,49 @@
+/*
+ * fake_port.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef FAKE_PORT_H_
+#define FAKE_PORT_H_
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*< PWM period of the fake timer, full brightness */
+#define FAKE_PORT_PWM_PERIOD (999U)
+
+/**
+ * @brief Apply the BSRR writes to the pin levels, as the GPIO does.
+ *
+ * @param port Fake port.
+ */
+void fake_gpio_latch(GPIO_TypeDef *port);
+/**
+ * @brief Let time pass: the fake timer triggers a DMA write every step.
+ *
+ * @param ms Time in milliseconds.
+ */
+void fake_timer_run(uint32_t ms);
+/**
+ * @brief Get the fake PWM compare register.
+ *
+ * @return uint32_t Compare value.
+ */
+uint32_t fake_pwm_compare(void);
+/**
+ * @brief Get whether the fake timer is stepping.
+ *
+ * @return true if a pattern is being played.
+ */
+bool fake_timer_running(void);
+/**
+ * @brief Get the DMA writes done since the last start.
+ *
+ * @return uint32_t Words written.
+ */
+uint32_t fake_dma_writes(void);
+
+#endif /* FAKE_PORT_H_ */
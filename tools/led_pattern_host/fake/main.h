@@ -0,0 +1,57 @@
+/*
+ * main.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+#ifndef FAKE_MAIN_H_
+#define FAKE_MAIN_H_
+
+/*
+ * Host stand-in of Core/Inc/main.h for the led pattern engine: the GPIO
+ * registers and the board pins it uses. tools/ao_replay_host shares it, with
+ * the Cortex-M intrinsics of the AO core.
+ */
+
+#include <stdint.h>
+
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+typedef struct {
+  volatile uint32_t ODR;  /*< Pin levels, applied by fake_gpio_latch */
+  volatile uint32_t BSRR; /*< Written by the engine and the fake DMA */
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef fake_gpiob;
+extern GPIO_TypeDef fake_gpioc;
+
+#define GPIOB (&fake_gpiob)
+#define GPIOC (&fake_gpioc)
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_7 ((uint16_t)0x0080)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+
+#define USER_Btn_Pin GPIO_PIN_13
+#define USER_Btn_GPIO_Port GPIOC
+#define LD1_Pin GPIO_PIN_0
+#define LD1_GPIO_Port GPIOB
+#define LD3_Pin GPIO_PIN_14
+#define LD3_GPIO_Port GPIOB
+#define LD2_Pin GPIO_PIN_7
+#define LD2_GPIO_Port GPIOB
+
+/* A single host thread runs the AOs, exclusive stores always succeed */
+#define __DMB() __asm__ volatile("" ::: "memory")
+#define __CLREX() ((void)0)
+
+static inline uint32_t __LDREXW(volatile uint32_t *addr) { return *addr; }
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) {
+  *addr = value;
+  return 0U;
+}
+
+#endif /* FAKE_MAIN_H_ */
@@ -0,0 +1,94 @@
+/*
+ * led_pattern_check.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+/*
+ * Plays every led pattern against the fake timer and GPIO and prints what the
+ * leds show at each step, two periods each. check.sh compares it with
+ * expected.txt.
+ */
+
+#include "board.h"
+#include "fake_port.h"
+#include "led_pattern.h"
+#include <stdio.h>
+
+/*< Periods of a pattern printed */
+#define CHECK_PERIODS (2U)
+
+static const char *const check_names_[LED_PATTERN__N] = {
+    [LED_PATTERN_NONE] = "none",
+    [LED_PATTERN_BLINK] = "blink",
+    [LED_PATTERN_SOS] = "sos",
+    [LED_PATTERN_BREATHE] = "breathe",
+};
+
+/**
+ * @brief Steps of one period of a pattern, as played.
+ */
+static uint16_t check_period_(const led_pattern_t *pattern) {
+  uint16_t count = pattern->steps_count;
+  if (pattern->mirror && count > 2)
+    count = (uint16_t)(2 * count - 2);
+  return count;
+}
+
+/**
+ * @brief Play a pattern and print a line per period.
+ *
+ * @param id Pattern.
+ * @param pins Pins of LED_A_PORT.
+ * @param label Name of the pins.
+ */
+static void check_play_(led_pattern_id_t id, uint16_t pins,
+                        const char *label) {
+  const led_pattern_t *pattern = led_pattern_get(id);
+  fake_gpiob.ODR = 0;
+  fake_gpiob.BSRR = 0;
+  int err = led_pattern_play(id, LED_A_PORT, pins);
+  printf("%s on %s: %s", check_names_[id], label, err ? "rejected\n" : "");
+  if (err)
+    return;
+  fake_gpio_latch(LED_A_PORT); // First step, written by the CPU.
+
+  uint16_t period = check_period_(pattern);
+  printf("%u steps of %u ms\n", period, pattern->step_ms);
+  for (uint32_t p = 0; p < CHECK_PERIODS; p++) {
+    printf(" ");
+    for (uint16_t s = 0; s < period; s++) {
+      if (pattern->kind == LED_PATTERN_KIND_PWM)
+        printf(" %lu", (unsigned long)fake_pwm_compare());
+      else
+        printf("%c", (fake_gpiob.ODR & pins) == pins   ? '#'
+                     : (fake_gpiob.ODR & pins) == 0 ? '.'
+                                                     : '?');
+      fake_timer_run(pattern->step_ms);
+    }
+    printf("\n");
+  }
+  printf("  dma writes %lu, pins 0x%04X\n", (unsigned long)fake_dma_writes(),
+         led_pattern_pins(LED_A_PORT));
+
+  led_pattern_stop();
+  uint32_t odr = fake_gpiob.ODR;
+  fake_timer_run(10U * pattern->step_ms);
+  printf("  stopped: timer %s, leds %s, pins 0x%04X\n",
+         fake_timer_running() ? "running" : "off",
+         fake_gpiob.ODR == odr ? "held" : "changed",
+         led_pattern_pins(LED_A_PORT));
+}
+
+int main(void) {
+  led_pattern_init();
+
+  check_play_(LED_PATTERN_BLINK, LED_A_PIN, "led a");
+  check_play_(LED_PATTERN_BLINK, LED_B_PIN | LED_C_PIN, "leds b c");
+  check_play_(LED_PATTERN_SOS, LED_A_PIN, "led a");
+  check_play_(LED_PATTERN_BREATHE, LED_A_PIN, "led a");
+  // Only led A is routed to a PWM channel.
+  check_play_(LED_PATTERN_BREATHE, LED_B_PIN, "led b");
+  return 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Build trace_decode, decode the fixtures and compare the JSON and the
+# summary with fixtures/expected. Run from anywhere. With --update the
+# expected output is rewritten instead, review its diff before committing.
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+repo="$here/../.."
+fixtures="$here/fixtures"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+${CC:-cc} -std=gnu11 -O2 -Wall -Wextra -Wpedantic -Werror -I"$repo/app/inc" \
+  "$here/trace_decode.c" -o "$out/trace_decode"
+
+status=0
+for name in snapshot stream; do
+  (cd "$fixtures" &&
+    "$out/trace_decode" -o "$out/$name.json" "$name.bin" \
+      > "$out/$name.txt" 2>&1)
+  for ext in json txt; do
+    if [ "$1" = "--update" ]; then
+      cp "$out/$name.$ext" "$fixtures/expected/$name.$ext"
+    elif ! diff -u "$fixtures/expected/$name.$ext" "$out/$name.$ext"; then
+      status=1
+    fi
+  done
+done
+
+[ $status -eq 0 ] && echo "trace_decode: ok"
+exit $status
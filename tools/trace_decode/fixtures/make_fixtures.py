@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+#
+# make_fixtures.py
+#
+#  Created on: Oct 18, 2026
+#      Author: guirespi
+#
+# Writes the trace_decode fixtures, laid out as app/inc/trace_format.h:
+#   snapshot.bin  'trace_buffer' as dumped by the debugger, ring wrapped.
+#   stream.bin    USART3 capture, with noise between frames, a renamed
+#                 object, records split over frames and a cut last frame.
+# Both hold the same scene: a button press posted to the UI AO, which posts
+# to the led AO, with the TIM2 handler and a mark in between. The cycle
+# counter wraps in the stream one.
+#
+# The fixtures are committed, run this only to change them, then refresh
+# the expected output with 'check.sh --update'.
+
+import os
+import struct
+
+MAGIC = 0x31435254  # "TRC1"
+FRAME_MAGIC = 0x46435254  # "TRCF"
+VERSION = 1
+MODE_SNAPSHOT, MODE_STREAM = 0, 1
+CPU_HZ = 168000000
+NAME_LEN = 14
+
+(REC_NONE, TASK_IN, TASK_OUT, TASK_READY, TICK, QUEUE_SEND, QUEUE_RECEIVE,
+ ISR_ENTER, ISR_EXIT, AO_POST, AO_BEGIN, AO_END, MARK) = range(13)
+OBJ_TASK, OBJ_QUEUE, OBJ_AO, OBJ_ISR, OBJ_MARK = 1, 2, 3, 4, 5
+FRAME_HEADER, FRAME_OBJECTS, FRAME_RECORDS = 1, 2, 3
+
+NO_AO = 0xFF
+TIM2 = 28 + 16
+
+OBJECTS = [
+    (OBJ_TASK, 1, "IDLE"),
+    (OBJ_TASK, 2, "task_button"),
+    (OBJ_TASK, 3, "ao_ui"),
+    (OBJ_TASK, 4, "ao_led"),
+    (OBJ_QUEUE, 1, "ui_queue"),
+    (OBJ_QUEUE, 2, "led_queue"),
+    (OBJ_AO, 0, "ui"),
+    (OBJ_AO, 1, "led_group"),
+    (OBJ_ISR, TIM2, "TIM2"),
+    (OBJ_MARK, 1, "press"),
+]
+
+
+def us(t):
+    """Microseconds to cycles."""
+    return int(t * CPU_HZ / 1000000)
+
+
+def scene(press):
+    """Records of one press, (time in us, type, id, arg), from 'press' us."""
+    t = press
+    return [
+        (t + 0, TASK_OUT, 1, 0),
+        (t + 1, TASK_IN, 2, 0),
+        (t + 5, MARK, 1, press // 1000),
+        (t + 8, AO_POST, 0, NO_AO << 8 | 1),
+        (t + 9, QUEUE_SEND, 1, 0),
+        (t + 12, TASK_OUT, 2, 0),
+        (t + 13, TASK_IN, 3, 0),
+        (t + 14, QUEUE_RECEIVE, 1, 1),
+        (t + 16, AO_BEGIN, 0, NO_AO << 8 | 1),
+        (t + 30, ISR_ENTER, TIM2, 0),
+        (t + 33, ISR_EXIT, TIM2, 0),
+        (t + 41, AO_POST, 1, 0 << 8 | 2),
+        (t + 42, QUEUE_SEND, 2, 0),
+        (t + 60, AO_END, 0, 0),
+        (t + 62, TASK_OUT, 3, 0),
+        (t + 63, TASK_IN, 4, 0),
+        (t + 64, QUEUE_RECEIVE, 2, 1),
+        (t + 66, AO_BEGIN, 1, 0 << 8 | 2),
+        (t + 66 + 10 * (press // 1000 + 1), AO_END, 1, 0),
+        (t + 120, TASK_OUT, 4, 0),
+        (t + 121, TASK_IN, 1, 0),
+    ]
+
+
+def rec(cyc, rtype, rid, arg):
+    return struct.pack("<IBBH", cyc & 0xFFFFFFFF, rtype, rid, arg)
+
+
+def obj(kind, oid, name):
+    return struct.pack("<BB14s", kind, oid, name.encode()[:NAME_LEN])
+
+
+def header(mode, objects, capacity, head, dropped):
+    return struct.pack("<IBBHIIII", MAGIC, VERSION, mode, objects, CPU_HZ,
+                       capacity, head, dropped)
+
+
+def frame(kind, items):
+    return struct.pack("<IBBH", FRAME_MAGIC, kind, 0, len(items)) + \
+        b"".join(items)
+
+
+def snapshot(path):
+    objects, capacity = 16, 32
+    records = []
+    for press in (0, 1000, 2000):
+        records += scene(press)
+    # The ring keeps the newest 'capacity', the oldest records are lost.
+    head = len(records)
+    ring = [rec(0, REC_NONE, 0, 0)] * capacity
+    for i, (t, rtype, rid, arg) in enumerate(records):
+        ring[i % capacity] = rec(us(t) + 1000, rtype, rid, arg)
+    table = [obj(*o) for o in OBJECTS]
+    table += [obj(0, 0, "")] * (objects - len(table))
+    with open(path, "wb") as f:
+        f.write(header(MODE_SNAPSHOT, objects, capacity, head, 0))
+        f.write(b"".join(table))
+        f.write(b"".join(ring))
+
+
+def stream(path):
+    base = 0xFFFFFFFF - us(1500)  # Wraps during the second press.
+    records = []
+    for press in (0, 1000, 2000):
+        records += [rec(base + us(t), *r) for t, *r in scene(press)]
+    table = [obj(*o) for o in OBJECTS]
+    renamed = [obj(OBJ_AO, 1, "leds") if o[:2] == (OBJ_AO, 1) else obj(*o)
+               for o in OBJECTS]
+    out = b"\x00\x55noise"  # Capture started mid-frame.
+    out += frame(FRAME_HEADER, [header(MODE_STREAM, len(table), 1024, 0, 3)])
+    out += frame(FRAME_OBJECTS, table)
+    out += frame(FRAME_RECORDS, records[:15])
+    out += b"\xff\xfe"  # Line noise.
+    out += frame(FRAME_RECORDS, records[15:40])
+    out += frame(FRAME_OBJECTS, renamed)
+    out += frame(FRAME_RECORDS, records[40:])
+    out += frame(FRAME_RECORDS, [rec(0, MARK, 1, 0)] * 4)[:-10]  # Cut.
+    with open(path, "wb") as f:
+        f.write(out)
+
+
+if __name__ == "__main__":
+    here = os.path.dirname(os.path.abspath(__file__))
+    snapshot(os.path.join(here, "snapshot.bin"))
+    stream(os.path.join(here, "stream.bin"))
@@ -0,0 +1,579 @@
+/*
+ * trace_decode.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: guirespi
+ */
+
+/*
+ * Host decoder of the trace recorder (app/inc/trace_format.h).
+ *
+ * Reads a snapshot, the memory of 'trace_buffer' dumped by the debugger, or a
+ * stream captured from USART3, and writes a Chrome trace-event JSON file,
+ * opened by Perfetto (ui.perfetto.dev) or chrome://tracing:
+ *   - Tasks and interrupt handlers as slices, one track each.
+ *   - AO handlers as slices, one track per AO, named after the signal.
+ *   - Queue depths as counters.
+ *   - Flow arrows from each AO post to the handler run of that message.
+ * Then it prints, per AO, the wait (post to handler) and run (handler)
+ * percentiles in microseconds.
+ *
+ * Build and run, from the repository root:
+ *   gcc -std=gnu11 -O2 -Wall -Iapp/inc tools/trace_decode/trace_decode.c \
+ *       -o trace_decode
+ *   ./trace_decode -o trace.json trace.bin
+ *
+ * tools/trace_decode/check.sh decodes the fixtures and compares the output.
+ *
+ * Posts and handler runs are paired per receiver in order, by sender and
+ * first payload byte. Messages discarded by an overflow policy or collapsed
+ * by a coalescing AO leave posts without run, they are not counted.
+ */
+
+#include "trace_format.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*< Object ids, and AO ids, are 8 bits */
+#define DECODE_IDS (256)
+/*< Posts waiting for their handler run, per AO */
+#define DECODE_MAX_POSTS (64)
+/*< Track of an interrupt handler, past the task ones */
+#define DECODE_ISR_TID(exc) (DECODE_IDS + (exc))
+/*< Perfetto processes */
+#define DECODE_PID_CPU (1)
+#define DECODE_PID_AO (2)
+#define DECODE_PID_QUEUE (3)
+
+typedef struct {
+  uint64_t *v;
+  size_t count;
+  size_t size;
+} decode_samples_t;
+
+typedef struct {
+  uint16_t arg;  /*< Sender and first byte */
+  uint64_t time; /*< Post time, cycles */
+  uint32_t tid;  /*< Track running when posted */
+  uint32_t flow; /*< Flow arrow id */
+} decode_post_t;
+
+typedef struct {
+  bool open;
+  uint64_t begin; /*< Handler start, cycles */
+  uint16_t arg;
+  decode_post_t post[DECODE_MAX_POSTS];
+  size_t posts;
+  decode_samples_t wait;
+  decode_samples_t run;
+  bool seen;
+} decode_ao_t;
+
+static struct {
+  FILE *out;
+  bool first_event;
+  double cyc_per_us;
+  uint32_t dropped;
+  uint64_t records;
+  /* Time, the 32 bit cycle counter unwrapped */
+  bool started;
+  uint32_t last_cyc;
+  uint64_t now;
+  uint64_t start;
+  /* Names, latest object table */
+  char name[TRACE_OBJ_MARK + 1][DECODE_IDS][TRACE_FORMAT_NAME_LEN + 1];
+  bool task_seen[DECODE_IDS];
+  bool isr_seen[DECODE_IDS];
+  bool queue_seen[DECODE_IDS];
+  /* Running task and interrupt handlers */
+  int task;
+  uint64_t task_in;
+  uint64_t isr_in[DECODE_IDS];
+  uint32_t isr_stack[DECODE_IDS];
+  size_t isr_depth;
+  uint32_t flow;
+  decode_ao_t ao[DECODE_IDS];
+} decode;
+
+static void decode_samples_add_(decode_samples_t *s, uint64_t v) {
+  if (s->count == s->size) {
+    s->size = s->size ? s->size * 2 : 64;
+    s->v = realloc(s->v, s->size * sizeof(*s->v));
+    if (s->v == NULL) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  s->v[s->count++] = v;
+}
+
+static int decode_cmp_(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Percentile of sorted samples, nearest rank.
+ */
+static double decode_pct_(const decode_samples_t *s, unsigned pct) {
+  if (s->count == 0)
+    return 0;
+  size_t rank = (s->count * pct + 99) / 100;
+  if (rank == 0)
+    rank = 1;
+  return (double)s->v[rank - 1] / decode.cyc_per_us;
+}
+
+static double decode_us_(uint64_t time) {
+  return (double)(time - decode.start) / decode.cyc_per_us;
+}
+
+static const char *decode_name_(uint8_t kind, uint8_t id) {
+  static char fallback[32];
+  if (kind <= TRACE_OBJ_MARK && decode.name[kind][id][0] != '\0')
+    return decode.name[kind][id];
+  static const char *prefix[] = {"object", "task", "queue", "ao", "irq",
+                                 "mark"};
+  snprintf(fallback, sizeof(fallback), "%s %u",
+           prefix[kind <= TRACE_OBJ_MARK ? kind : 0], (unsigned)id);
+  return fallback;
+}
+
+/**
+ * @brief Write a JSON string, escaped.
+ */
+static void decode_str_(const char *s) {
+  fputc('"', decode.out);
+  for (; *s != '\0'; s++) {
+    if (*s == '"' || *s == '\\')
+      fprintf(decode.out, "\\%c", *s);
+    else if ((unsigned char)*s < 0x20)
+      fprintf(decode.out, "\\u%04x", (unsigned)*s);
+    else
+      fputc(*s, decode.out);
+  }
+  fputc('"', decode.out);
+}
+
+/**
+ * @brief Start a trace event, the caller writes the rest and the '}'.
+ */
+static void decode_event_(const char *ph, const char *name, unsigned pid,
+                          unsigned tid, uint64_t time) {
+  fprintf(decode.out, "%s\n{\"ph\":\"%s\",\"name\":",
+          decode.first_event ? "" : ",", ph);
+  decode.first_event = false;
+  decode_str_(name);
+  fprintf(decode.out, ",\"pid\":%u,\"tid\":%u,\"ts\":%.3f", pid, tid,
+          decode_us_(time));
+}
+
+static void decode_slice_(const char *name, unsigned pid, unsigned tid,
+                          uint64_t begin, uint64_t end) {
+  decode_event_("X", name, pid, tid, begin);
+  fprintf(decode.out, ",\"dur\":%.3f}",
+          (double)(end - begin) / decode.cyc_per_us);
+}
+
+static void decode_objects_(const trace_obj_t *obj, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (obj[i].kind == TRACE_OBJ_NONE || obj[i].kind > TRACE_OBJ_MARK)
+      continue;
+    memcpy(decode.name[obj[i].kind][obj[i].id], obj[i].name,
+           TRACE_FORMAT_NAME_LEN);
+    decode.name[obj[i].kind][obj[i].id][TRACE_FORMAT_NAME_LEN] = '\0';
+  }
+}
+
+/**
+ * @brief Track of what runs now, the innermost interrupt or the task.
+ */
+static uint32_t decode_running_(void) {
+  if (decode.isr_depth > 0)
+    return DECODE_ISR_TID(decode.isr_stack[decode.isr_depth - 1]);
+  return decode.task < 0 ? 0 : (uint32_t)decode.task;
+}
+
+static void decode_ao_signal_(char *buf, size_t size, uint16_t arg) {
+  uint8_t sender = (uint8_t)(arg >> 8);
+  if (sender == 0xFF)
+    snprintf(buf, size, "sig %u", (unsigned)(arg & 0xFF));
+  else
+    snprintf(buf, size, "sig %u from %s", (unsigned)(arg & 0xFF),
+             decode_name_(TRACE_OBJ_AO, sender));
+}
+
+static void decode_ao_end_(uint8_t id, uint64_t time) {
+  decode_ao_t *ao = &decode.ao[id];
+  char name[64];
+  if (!ao->open)
+    return;
+  ao->open = false;
+  decode_ao_signal_(name, sizeof(name), ao->arg);
+  decode_slice_(name, DECODE_PID_AO, id, ao->begin, time);
+  decode_samples_add_(&ao->run, time - ao->begin);
+}
+
+static void decode_record_(const trace_rec_t *rec) {
+  if (rec->type == TRACE_REC_NONE || rec->type >= TRACE_REC_MAX)
+    return;
+
+  if (!decode.started) {
+    decode.started = true;
+    decode.last_cyc = rec->cyc;
+    decode.now = rec->cyc;
+    decode.start = decode.now;
+  }
+  decode.now += (uint32_t)(rec->cyc - decode.last_cyc);
+  decode.last_cyc = rec->cyc;
+  decode.records++;
+
+  uint64_t now = decode.now;
+  switch (rec->type) {
+  case TRACE_REC_TASK_IN: {
+    decode.task = rec->id;
+    decode.task_in = now;
+    decode.task_seen[rec->id] = true;
+    break;
+  }
+  case TRACE_REC_TASK_OUT: {
+    if (decode.task == rec->id)
+      decode_slice_(decode_name_(TRACE_OBJ_TASK, rec->id), DECODE_PID_CPU,
+                    rec->id, decode.task_in, now);
+    decode.task = -1;
+    break;
+  }
+  case TRACE_REC_ISR_ENTER: {
+    if (decode.isr_depth < DECODE_IDS)
+      decode.isr_stack[decode.isr_depth++] = rec->id;
+    decode.isr_in[rec->id] = now;
+    decode.isr_seen[rec->id] = true;
+    break;
+  }
+  case TRACE_REC_ISR_EXIT: {
+    if (decode.isr_depth > 0 &&
+        decode.isr_stack[decode.isr_depth - 1] == rec->id) {
+      decode.isr_depth--;
+      decode_slice_(decode_name_(TRACE_OBJ_ISR, rec->id), DECODE_PID_CPU,
+                    DECODE_ISR_TID(rec->id), decode.isr_in[rec->id], now);
+    }
+    break;
+  }
+  case TRACE_REC_QUEUE_SEND:
+  case TRACE_REC_QUEUE_RECEIVE: {
+    // Depths are taken before the operation.
+    int depth = rec->arg + (rec->type == TRACE_REC_QUEUE_SEND ? 1 : -1);
+    decode_event_("C", decode_name_(TRACE_OBJ_QUEUE, rec->id),
+                  DECODE_PID_QUEUE, rec->id, now);
+    fprintf(decode.out, ",\"args\":{\"depth\":%d}}", depth < 0 ? 0 : depth);
+    decode.queue_seen[rec->id] = true;
+    break;
+  }
+  case TRACE_REC_AO_POST: {
+    decode_ao_t *ao = &decode.ao[rec->id];
+    if (ao->posts == DECODE_MAX_POSTS) {
+      // Never run, e.g. discarded. Forget the oldest.
+      memmove(&ao->post[0], &ao->post[1],
+              (DECODE_MAX_POSTS - 1) * sizeof(ao->post[0]));
+      ao->posts--;
+    }
+    decode_post_t *post = &ao->post[ao->posts++];
+    post->arg = rec->arg;
+    post->time = now;
+    post->tid = decode_running_();
+    post->flow = ++decode.flow;
+    ao->seen = true;
+    break;
+  }
+  case TRACE_REC_AO_BEGIN: {
+    decode_ao_t *ao = &decode.ao[rec->id];
+    decode_ao_end_(rec->id, now); // Deinit in its handler, no end.
+    ao->open = true;
+    ao->begin = now;
+    ao->arg = rec->arg;
+    ao->seen = true;
+    for (size_t i = 0; i < ao->posts; i++) {
+      if (ao->post[i].arg != rec->arg)
+        continue;
+      decode_post_t post = ao->post[i];
+      memmove(&ao->post[i], &ao->post[i + 1],
+              (ao->posts - i - 1) * sizeof(ao->post[0]));
+      ao->posts--;
+      decode_samples_add_(&ao->wait, now - post.time);
+      decode_event_("s", "message", DECODE_PID_CPU, post.tid, post.time);
+      fprintf(decode.out, ",\"cat\":\"ao\",\"id\":%u}", post.flow);
+      decode_event_("f", "message", DECODE_PID_AO, rec->id, now);
+      fprintf(decode.out, ",\"cat\":\"ao\",\"id\":%u,\"bp\":\"e\"}",
+              post.flow);
+      break;
+    }
+    break;
+  }
+  case TRACE_REC_AO_END: {
+    decode_ao_end_(rec->id, now);
+    break;
+  }
+  case TRACE_REC_MARK: {
+    decode_event_("i", decode_name_(TRACE_OBJ_MARK, rec->id), DECODE_PID_CPU,
+                  decode_running_(), now);
+    fprintf(decode.out, ",\"s\":\"t\",\"args\":{\"value\":%u}}",
+            (unsigned)rec->arg);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+static bool decode_header_(const trace_header_t *header) {
+  if (header->version != TRACE_FORMAT_VERSION) {
+    fprintf(stderr, "trace version %u, expected %u\n",
+            (unsigned)header->version, TRACE_FORMAT_VERSION);
+    return false;
+  }
+  if (header->cpu_hz < 1000000U) {
+    fprintf(stderr, "bad cycle counter frequency %u\n",
+            (unsigned)header->cpu_hz);
+    return false;
+  }
+  decode.cyc_per_us = header->cpu_hz / 1e6;
+  decode.dropped = header->dropped;
+  return true;
+}
+
+static bool decode_snapshot_(const uint8_t *data, size_t size) {
+  trace_header_t header;
+  memcpy(&header, data, sizeof(header));
+  if (!decode_header_(&header))
+    return false;
+  if (header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0) {
+    fprintf(stderr, "bad ring capacity %u\n", (unsigned)header.capacity);
+    return false;
+  }
+  size_t need = sizeof(header) + header.objects * sizeof(trace_obj_t) +
+                (size_t)header.capacity * sizeof(trace_rec_t);
+  if (size < need) {
+    fprintf(stderr, "snapshot of %zu bytes, expected %zu\n", size, need);
+    return false;
+  }
+
+  const uint8_t *p = data + sizeof(header);
+  trace_obj_t *obj = malloc(header.objects * sizeof(trace_obj_t) + 1);
+  if (obj == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+  memcpy(obj, p, header.objects * sizeof(trace_obj_t));
+  decode_objects_(obj, header.objects);
+  free(obj);
+  p += header.objects * sizeof(trace_obj_t);
+
+  // Oldest first, once wrapped it is the next to be overwritten.
+  bool wrapped = header.head >= header.capacity;
+  uint32_t count = wrapped ? header.capacity : header.head;
+  uint32_t first = wrapped ? header.head : 0;
+  for (uint32_t i = 0; i < count; i++) {
+    trace_rec_t rec;
+    uint32_t index = (first + i) & (header.capacity - 1U);
+    memcpy(&rec, p + index * sizeof(rec), sizeof(rec));
+    decode_record_(&rec);
+  }
+  return true;
+}
+
+static bool decode_stream_(const uint8_t *data, size_t size) {
+  bool header_seen = false;
+  size_t skipped = 0;
+  size_t pos = 0;
+
+  while (pos + sizeof(trace_frame_t) <= size) {
+    trace_frame_t frame;
+    memcpy(&frame, data + pos, sizeof(frame));
+    size_t item = frame.kind == TRACE_FRAME_HEADER    ? sizeof(trace_header_t)
+                  : frame.kind == TRACE_FRAME_OBJECTS ? sizeof(trace_obj_t)
+                  : frame.kind == TRACE_FRAME_RECORDS ? sizeof(trace_rec_t)
+                                                      : 0;
+    size_t body = item * frame.count;
+    if (frame.magic != TRACE_FORMAT_FRAME_MAGIC || item == 0 ||
+        pos + sizeof(frame) + body > size) {
+      pos++; // Not a frame, or cut. Look for the next one.
+      skipped++;
+      continue;
+    }
+    const uint8_t *p = data + pos + sizeof(frame);
+    pos += sizeof(frame) + body;
+
+    if (frame.kind == TRACE_FRAME_HEADER) {
+      trace_header_t header;
+      memcpy(&header, p, sizeof(header));
+      if (!decode_header_(&header))
+        return false;
+      header_seen = true;
+    } else if (!header_seen) {
+      continue; // No frequency yet.
+    } else if (frame.kind == TRACE_FRAME_OBJECTS) {
+      trace_obj_t *obj = malloc(body + 1);
+      if (obj == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return false;
+      }
+      memcpy(obj, p, body);
+      decode_objects_(obj, frame.count);
+      free(obj);
+    } else {
+      for (uint16_t i = 0; i < frame.count; i++) {
+        trace_rec_t rec;
+        memcpy(&rec, p + i * sizeof(rec), sizeof(rec));
+        decode_record_(&rec);
+      }
+    }
+  }
+  if (!header_seen) {
+    fprintf(stderr, "no trace header in the stream\n");
+    return false;
+  }
+  if (skipped > 0)
+    fprintf(stderr, "%zu bytes out of frames skipped\n", skipped);
+  return true;
+}
+
+static void decode_thread_name_(unsigned pid, unsigned tid,
+                                const char *name) {
+  decode_event_("M", "thread_name", pid, tid, decode.start);
+  fprintf(decode.out, ",\"args\":{\"name\":");
+  decode_str_(name);
+  fprintf(decode.out, "}}");
+}
+
+static void decode_process_name_(unsigned pid, const char *name) {
+  decode_event_("M", "process_name", pid, 0, decode.start);
+  fprintf(decode.out, ",\"args\":{\"name\":");
+  decode_str_(name);
+  fprintf(decode.out, "}}");
+}
+
+static void decode_finish_(void) {
+  decode_process_name_(DECODE_PID_CPU, "CPU");
+  decode_process_name_(DECODE_PID_AO, "AO handlers");
+  decode_process_name_(DECODE_PID_QUEUE, "Queues");
+  for (unsigned id = 0; id < DECODE_IDS; id++) {
+    if (decode.task_seen[id])
+      decode_thread_name_(DECODE_PID_CPU, id, decode_name_(TRACE_OBJ_TASK, id));
+    if (decode.isr_seen[id])
+      decode_thread_name_(DECODE_PID_CPU, DECODE_ISR_TID(id),
+                          decode_name_(TRACE_OBJ_ISR, id));
+    if (decode.ao[id].seen)
+      decode_thread_name_(DECODE_PID_AO, id, decode_name_(TRACE_OBJ_AO, id));
+  }
+  fprintf(decode.out, "\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+static void decode_summary_(void) {
+  printf("%llu records over %.3f ms, %u dropped\n",
+         (unsigned long long)decode.records,
+         (double)(decode.now - decode.start) / decode.cyc_per_us / 1000.0,
+         (unsigned)decode.dropped);
+  printf("%-14s %6s %-4s %9s %9s %9s %9s\n", "AO (us)", "count", "", "p50",
+         "p90", "p99", "max");
+  for (unsigned id = 0; id < DECODE_IDS; id++) {
+    decode_ao_t *ao = &decode.ao[id];
+    if (!ao->seen)
+      continue;
+    decode_samples_t *samples[] = {&ao->wait, &ao->run};
+    const char *what[] = {"wait", "run"};
+    for (unsigned i = 0; i < 2; i++) {
+      decode_samples_t *s = samples[i];
+      qsort(s->v, s->count, sizeof(*s->v), decode_cmp_);
+      printf("%-14s %6zu %-4s %9.1f %9.1f %9.1f %9.1f\n",
+             i == 0 ? decode_name_(TRACE_OBJ_AO, id) : "", s->count, what[i],
+             decode_pct_(s, 50), decode_pct_(s, 90), decode_pct_(s, 99),
+             decode_pct_(s, 100));
+    }
+  }
+}
+
+static uint8_t *decode_read_(const char *path, size_t *size) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    perror(path);
+    return NULL;
+  }
+  size_t cap = 1 << 16, len = 0;
+  uint8_t *data = malloc(cap);
+  size_t n;
+  while (data != NULL && (n = fread(data + len, 1, cap - len, f)) > 0) {
+    len += n;
+    if (len == cap) {
+      uint8_t *grown = realloc(data, cap * 2);
+      if (grown == NULL)
+        free(data);
+      data = grown;
+      cap *= 2;
+    }
+  }
+  if (data == NULL)
+    fprintf(stderr, "%s: out of memory\n", path);
+  else if (ferror(f)) {
+    perror(path);
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  *size = len;
+  return data;
+}
+
+static void decode_usage_(const char *argv0) {
+  fprintf(stderr, "usage: %s [-o trace.json] <snapshot or stream file>\n",
+          argv0);
+}
+
+int main(int argc, char *argv[]) {
+  const char *in = NULL, *out = "trace.json";
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      out = argv[++i];
+    else if (argv[i][0] == '-' || in != NULL) {
+      decode_usage_(argv[0]);
+      return 2;
+    } else
+      in = argv[i];
+  }
+  if (in == NULL) {
+    decode_usage_(argv[0]);
+    return 2;
+  }
+
+  size_t size;
+  uint8_t *data = decode_read_(in, &size);
+  if (data == NULL)
+    return 1;
+
+  decode.out = fopen(out, "w");
+  if (decode.out == NULL) {
+    perror(out);
+    return 1;
+  }
+  decode.first_event = true;
+  decode.task = -1;
+  fprintf(decode.out, "{\"traceEvents\":[");
+
+  uint32_t magic = 0;
+  if (size >= sizeof(magic))
+    memcpy(&magic, data, sizeof(magic));
+  bool ok = (magic == TRACE_FORMAT_MAGIC && size >= sizeof(trace_header_t))
+                ? decode_snapshot_(data, size)
+                : decode_stream_(data, size);
+  if (ok)
+    decode_finish_();
+  fclose(decode.out);
+  free(data);
+  if (!ok)
+    return 1;
+
+  decode_summary_();
+  return 0;
+}